@@ -11,8 +11,11 @@
 #include <vector>
 #include <iterator>
 #include <algorithm>
+#include <thread>
+#include <utility>
 #include "./MlipSolver.h"
 #include "./FptSolver.h"
+#include "./ThreadPool.h"
 
 using boost::filesystem::path;
 using boost::filesystem::directory_iterator;
@@ -25,6 +28,19 @@ using std::sort;
 using std::setw;
 using std::ofstream;
 
+// ____________________________________________________________________________
+Evaluator::Evaluator(const size_t threads, FptOptions fptOptions) {
+  _threads = std::max<size_t>(threads, 1);
+  _fptOptions = fptOptions;
+  _mlipThreads = 0;
+  // share the cores between the concurrent MLIP solves.
+  if (_threads > 1) {
+    size_t cores = std::thread::hardware_concurrency();
+    _mlipThreads = static_cast<int>(std::max<size_t>(cores / _threads, 1));
+  }
+  _instSize = 0;
+}
+
 // ____________________________________________________________________________
 void Evaluator::evaluate(const string& inPath, bool unitPrize) {
   // reading all graphs in the folder and adding it to graph list.
@@ -40,39 +56,66 @@ void Evaluator::evaluate(const string& inPath, bool unitPrize) {
     std::sort(v.begin(), v.end());
     for (vec::const_iterator it(v.begin()); it != v.end(); ++it) {
       Graph g;
-      g.buildFromFile((*it).string(), unitPrize);
-      _graphs.push_back(g);
+      if (it->extension() == ".bgraph") {
+        g.buildFromBinary((*it).string(), unitPrize);
+      } else {
+        g.buildFromFile((*it).string(), unitPrize);
+      }
+      _instances.push_back(std::make_shared<const Instance>(std::move(g)));
     }
   }
-  _instSize = _graphs[0].getNodesNum() - 1;
+  _instSize = _instances[0]->graph().getNodesNum() - 1;
 
   // Now solving all the graphs with both solver types and store
-  // runtimes and found paths.
-  for (auto graph : _graphs) {
-    MlipSolver m = MlipSolver(graph);
-    FptSolver f = FptSolver(graph);
-    struct timespec start, finish;
-    double elapsed;
-    clock_gettime(CLOCK_MONOTONIC, &start);
-    auto resultFpt = f.solve();
-    clock_gettime(CLOCK_MONOTONIC, &finish);
-    elapsed = (finish.tv_sec - start.tv_sec) * 1000;
-    elapsed += (finish.tv_nsec - start.tv_nsec) / (1000 * 1000);
-    _fptPaths.push_back(f.getTour(std::get<1>(resultFpt)));
-    _fptRuntimes.push_back(elapsed);
-    _fptPrizes.push_back(std::get<0>(resultFpt));
-
-    clock_gettime(CLOCK_MONOTONIC, &start);
-    auto resultMlip = m.solve();
-    clock_gettime(CLOCK_MONOTONIC, &finish);
-    elapsed = (finish.tv_sec - start.tv_sec) * 1000;
-    elapsed += (finish.tv_nsec - start.tv_nsec) / (1000 * 1000);
-    _mlipPaths.push_back(m.getTour());
-    _mlipRuntimes.push_back(elapsed);
-    _mlipPrizes.push_back(resultMlip);
+  // runtimes and found paths. Every instance has its own result slots,
+  // so the results do not depend on the order the workers finish in.
+  size_t numGraphs = _instances.size();
+  _fptPaths.resize(numGraphs);
+  _fptRuntimes.resize(numGraphs);
+  _fptPrizes.resize(numGraphs);
+  _fptStats.resize(numGraphs);
+  _fptBounds.resize(numGraphs);
+  _mlipPaths.resize(numGraphs);
+  _mlipRuntimes.resize(numGraphs);
+  _mlipPrizes.resize(numGraphs);
+  if (_threads > 1) {
+    ThreadPool pool(std::min(_threads, numGraphs));
+    pool.run(numGraphs, [this](size_t idx) { solveInstance(idx); });
+  } else {
+    for (size_t idx = 0; idx < numGraphs; idx++) {
+      solveInstance(idx);
+    }
   }
 }
 
+// ____________________________________________________________________________
+void Evaluator::solveInstance(const size_t idx) {
+  const SharedInstance& instance = _instances[idx];
+  MlipSolver m = MlipSolver(instance, _mlipThreads);
+  FptSolver f = FptSolver(instance, _fptOptions);
+  struct timespec start, finish;
+  double elapsed;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  auto resultFpt = f.solve();
+  clock_gettime(CLOCK_MONOTONIC, &finish);
+  elapsed = (finish.tv_sec - start.tv_sec) * 1000;
+  elapsed += (finish.tv_nsec - start.tv_nsec) / (1000.0 * 1000.0);
+  _fptPaths[idx] = f.getTour(std::get<1>(resultFpt));
+  _fptRuntimes[idx] = elapsed;
+  _fptPrizes[idx] = std::get<0>(resultFpt);
+  _fptStats[idx] = std::get<2>(resultFpt);
+  _fptBounds[idx] = f.upperBound();
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  auto resultMlip = m.solve();
+  clock_gettime(CLOCK_MONOTONIC, &finish);
+  elapsed = (finish.tv_sec - start.tv_sec) * 1000;
+  elapsed += (finish.tv_nsec - start.tv_nsec) / (1000.0 * 1000.0);
+  _mlipPaths[idx] = m.getTour();
+  _mlipRuntimes[idx] = elapsed;
+  _mlipPrizes[idx] = resultMlip;
+}
+
 // ____________________________________________________________________________
 void Evaluator::writeResults(const string& outPath, bool unitPrizes) {
   path resultPath(initial_path() / outPath);
@@ -109,6 +152,44 @@ void Evaluator::writeResults(const string& outPath, bool unitPrizes) {
       idx++;
     }
   }
+  // Writing the search effort of the FPT solver.
+  string statsOut = resultPath.string() + "/" + instSize + "_FPT"
+                    + uP + "stats.txt";
+  ofstream statsFile(statsOut);
+  if (statsFile.is_open()) {
+    statsFile << "Search effort of the FPT solver for Instances of size "
+              << instSize << std::endl
+              << setw(4) << "Id " << "|"
+              << setw(10) << "Labels " << "|"
+              << setw(11) << "Generated " << "|"
+              << setw(10) << "Deadline " << "|"
+              << setw(11) << "Dominated " << "|"
+              << setw(9) << "Removed " << "|"
+              << setw(8) << "Pruned " << "|"
+              << setw(8) << "Widest " << "|"
+              << setw(8) << "Prohib " << "|"
+              << setw(7) << "Bound " << "|"
+              << " Labels per level" << std::endl;
+    for (size_t idx = 0; idx < _fptStats.size(); idx++) {
+      const FptStats& stats = _fptStats[idx];
+      statsFile << setw(3) << idx << " |"
+                << setw(9) << stats.labels << " |"
+                << setw(10) << stats.generated << " |"
+                << setw(9) << stats.deadlineMisses << " |"
+                << setw(10) << stats.dominatedOnInsert << " |"
+                << setw(8) << stats.removedFromCell << " |"
+                << setw(7) << stats.pruned << " |"
+                << setw(7) << stats.widestFront << " |"
+                << setw(7) << std::fixed << std::setprecision(2)
+                << stats.averageProhib() << " |";
+      statsFile.unsetf(std::ios::floatfield);
+      statsFile << setw(6) << _fptBounds[idx] << " |";
+      for (size_t level = 1; level < stats.levelLabels.size(); level++) {
+        statsFile << " " << stats.levelLabels[level];
+      }
+      statsFile << std::endl;
+    }
+  }
   // Writing paths to file.
   string toursOut = resultPath.string() + "/" + instSize + "_FPT"
                     + uP + "paths.txt";
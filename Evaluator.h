@@ -6,7 +6,9 @@
 
 #include <string>
 #include <vector>
+#include "./FptSolver.h"
 #include "./Graph.h"
+#include "./Instance.h"
 using std::string;
 
 // Class that reads graphs from a folder, solves the graphs
@@ -15,19 +17,35 @@ using std::string;
 
 class Evaluator {
  public:
+  // Constructor. With more than one thread the instances are solved
+  // concurrently, each worker solves one instance with FPT and then
+  // MLIP at a time. The FPT solver runs with fptOptions.
+  explicit Evaluator(size_t threads = 1,
+                     FptOptions fptOptions = FptOptions());
+
   // Function to evaluate all graphs with MLIP and FPT solver.
   void evaluate(const string& inPath, bool unitPrizes = false);
 
-  // Function that writes the solutions paths and runtimes to
-  // files.
+  // Function that writes the solutions paths, runtimes and the
+  // search effort of the FPT solver to files.
   void writeResults(const string& outPath, bool unitPrizes = false);
 
  private:
+  // Solves graph idx with both solvers and stores the results in the
+  // slots idx of the result vectors.
+  void solveInstance(size_t idx);
+
+  size_t _threads;
+  FptOptions _fptOptions;
+  int _mlipThreads;  // Gurobi threads per MLIP solve, 0 for its default.
   size_t _instSize;
-  vector<Graph> _graphs;
+  // The instances, each shared by its FPT and MLIP solver.
+  vector<SharedInstance> _instances;
   vector<double> _fptRuntimes;
   vector<double> _mlipRuntimes;
   vector<size_t> _fptPrizes;
+  vector<FptStats> _fptStats;
+  vector<size_t> _fptBounds;  // upper bounds of the FPT solves.
   vector<size_t> _mlipPrizes;
   vector<vector<Location>> _fptPaths;
   vector<vector<Location>> _mlipPaths;
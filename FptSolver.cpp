@@ -3,181 +3,1123 @@
 
 #include <tuple>
 #include <algorithm>
+#include <limits>
+#include <memory>
+#include <utility>
 #include <vector>
-#include <set>
 #include "FptSolver.h"
 
+// Executes a counting statement unless FPT_STATS is 0.
+#if FPT_STATS
+#define FPT_COUNT(...) do { __VA_ARGS__; } while (false)
+#else
+#define FPT_COUNT(...) do {} while (false)
+#endif
+
+
 // _____________________________________________________________________________
-bool Constraint::operator>(const Constraint &newConstr) {
-  if (newConstr.time > this->time || newConstr.revenue < this->revenue) {
-    return false;
-  } else {
-    std::set<size_t> intersection;
-    std::set_intersection(newConstr.prohibJobs.begin(),
-                    newConstr.prohibJobs.end(),
-                    this->prohibJobs.begin(), this->prohibJobs.end(),
-                    std::inserter(intersection, intersection.begin()));
-    return intersection == newConstr.prohibJobs;
+FptOptions::FptOptions() {
+  rollingLevels = false;
+  threads = 1;
+  pruneByBound = false;
+  bidirectional = false;
+  ngSize = 0;
+  beamWidth = 0;
+}
+
+// _____________________________________________________________________________
+FptStats::FptStats() {
+  labels = 0;
+  generated = 0;
+  deadlineMisses = 0;
+  pruned = 0;
+  dominatedOnInsert = 0;
+  removedFromCell = 0;
+  widestFront = 0;
+  prohibSum = 0;
+  backwardLabels = 0;
+  relaxedSolves = 0;
+  trimmed = 0;
+  levelLabels = {};
+}
+
+// _____________________________________________________________________________
+double FptStats::averageProhib() const {
+  return labels == 0 ? 0.0 : static_cast<double>(prohibSum) / labels;
+}
+
+// _____________________________________________________________________________
+void FptStats::add(const FptStats &other) {
+  labels += other.labels;
+  generated += other.generated;
+  deadlineMisses += other.deadlineMisses;
+  pruned += other.pruned;
+  dominatedOnInsert += other.dominatedOnInsert;
+  removedFromCell += other.removedFromCell;
+  widestFront = std::max(widestFront, other.widestFront);
+  prohibSum += other.prohibSum;
+  backwardLabels += other.backwardLabels;
+  relaxedSolves += other.relaxedSolves;
+  trimmed += other.trimmed;
+  if (levelLabels.size() < other.levelLabels.size()) {
+    levelLabels.resize(other.levelLabels.size(), 0);
+  }
+  for (size_t level = 0; level < other.levelLabels.size(); level++) {
+    levelLabels[level] += other.levelLabels[level];
   }
 }
 
+// _____________________________________________________________________________
+bool FptStats::operator==(const FptStats &other) const {
+  return labels == other.labels && generated == other.generated
+         && deadlineMisses == other.deadlineMisses && pruned == other.pruned
+         && dominatedOnInsert == other.dominatedOnInsert
+         && removedFromCell == other.removedFromCell
+         && widestFront == other.widestFront && prohibSum == other.prohibSum
+         && backwardLabels == other.backwardLabels
+         && relaxedSolves == other.relaxedSolves && trimmed == other.trimmed
+         && levelLabels == other.levelLabels;
+}
 
 FptSolver::~FptSolver() = default;
 
 // _____________________________________________________________________________
-FptSolver::FptSolver(Graph graph) {
-  _graph = graph;
-  _constraints = {};
+FptSolver::FptSolver(Graph graph, FptOptions options)
+    : FptSolver(std::make_shared<const Instance>(std::move(graph)), options) {
 }
 
 // _____________________________________________________________________________
-void FptSolver::initConstraints() {
-  size_t dimension = _graph.getNodesNum();
-  // Initialize empty field for constraints.
-  for (size_t i = 0; i < dimension; i++) {
-    vector<vector<Constraint>> level = {};
-    for (size_t j = 0; j < dimension; j++) {
-      vector<Constraint> constraint = {};
-      level.push_back(constraint);
+FptSolver::FptSolver(SharedInstance instance, FptOptions options) {
+  _instance = instance;
+  _graph = &_instance->graph();
+  _index = &_instance->index();
+  _prohibThresholds = _instance->prohibThresholds().data();
+  _options = options;
+  _fronts = {};
+  _pinnedSets = 0;
+  _latestStarts = {};
+  _sortedStarts = {};
+  _prizeSums = {};
+  _incumbent = 0;
+  _hasDeadline = false;
+  _cancel = nullptr;
+  _onImprovement = nullptr;
+  _stopped = false;
+  _stats = FptStats();
+  _midpoint = 0.0;
+  _joinOrder = {};
+  _joinedEnd = std::make_tuple(0, 0, 0);
+  _joinedStart = std::make_tuple(0, 0, 0);
+  _ngSets = {};
+  _ratioOrder = {};
+  _leastTimes = {};
+  _upperBound = 0;
+  // the relaxation only works for the plain forward search.
+  if (_options.ngSize > 0) {
+    _options.bidirectional = false;
+    _options.pruneByBound = false;
+    _options.beamWidth = 0;
+  }
+}
+
+// _____________________________________________________________________________
+bool FptSolver::outOfBudget() const {
+  if (_cancel != nullptr && _cancel->load()) {
+    return true;
+  }
+  return _hasDeadline && std::chrono::steady_clock::now() >= _deadline;
+}
+
+// _____________________________________________________________________________
+FptResult FptSolver::solveWithin(const double timeLimit,
+                                 const std::atomic<bool>* cancel,
+                                 ImprovementHook onImprovement) {
+  _deadline = std::chrono::steady_clock::now()
+              + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                  std::chrono::duration<double>(timeLimit));
+  _hasDeadline = true;
+  _cancel = cancel;
+  _onImprovement = onImprovement;
+  auto result = solve();
+  _hasDeadline = false;
+  _cancel = nullptr;
+  _onImprovement = nullptr;
+
+  FptResult budgeted;
+  budgeted.prize = std::get<0>(result);
+  // a tour end at node 0 means that no job could be visited at all,
+  // unless the tour consists of backward labels only.
+  if (std::get<1>(std::get<1>(result)) != 0
+      || std::get<0>(_joinedStart) != 0) {
+    budgeted.tour = getTour(std::get<1>(result));
+  }
+  budgeted.upperBound = _upperBound;
+  budgeted.optimal = !_stopped && _upperBound == budgeted.prize;
+  budgeted.stats = std::get<2>(result);
+  return budgeted;
+}
+
+// _____________________________________________________________________________
+void FptSolver::initBounds() {
+  size_t nodesNum = _graph->getNodesNum();
+  const size_t* releases = _graph->getReleases()->data();
+  const size_t* deadlines = _graph->getDeadlines()->data();
+  const size_t* durations = _graph->getDurations()->data();
+  const size_t* prizes = _graph->getPrizes()->data();
+  // the shortest paths keep the bound valid if the distances violate
+  // the triangle inequality.
+  const vector<double>& travel = _instance->shortestTravel();
+
+  // a small slack keeps the bound optimistic despite rounding.
+  const double slack = 1e-6;
+  const double never = -std::numeric_limits<double>::infinity();
+  _latestStarts.assign(nodesNum * nodesNum, never);
+  _sortedStarts.assign(nodesNum * nodesNum, never);
+  _prizeSums.assign(nodesNum * (nodesNum + 1), 0);
+  vector<size_t> order(nodesNum);
+  for (size_t from = 0; from < nodesNum; from++) {
+    double* latest = &_latestStarts[from * nodesNum];
+    for (size_t to = 1; to < nodesNum; to++) {
+      if (releases[to] + durations[to] <= deadlines[to]) {
+        latest[to] = static_cast<double>(deadlines[to]) - durations[to]
+                     - travel[from * nodesNum + to] + slack;
+      }
+    }
+    for (size_t i = 0; i < nodesNum; i++) {
+      order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [latest](size_t a, size_t b) {
+      return latest[a] > latest[b];
+    });
+    size_t* sums = &_prizeSums[from * (nodesNum + 1)];
+    for (size_t i = 0; i < nodesNum; i++) {
+      _sortedStarts[from * nodesNum + i] = latest[order[i]];
+      sums[i + 1] = sums[i] + (latest[order[i]] > never ? prizes[order[i]]
+                                                        : 0);
+    }
+  }
+
+  // the least time of a job for the time bound, every job of a tour but
+  // the first is reached from another job.
+  _leastTimes.assign(nodesNum, 0.0);
+  _ratioOrder.clear();
+  for (size_t to = 1; to < nodesNum; to++) {
+    if (!_index->servable(to)) {continue;}
+    double shortest = std::numeric_limits<double>::infinity();
+    for (size_t from = 1; from < nodesNum; from++) {
+      if (from != to) {
+        shortest = std::min(shortest, _graph->distance(from, to));
+      }
+    }
+    _leastTimes[to] = durations[to] + (nodesNum > 2 ? shortest : 0.0);
+    _ratioOrder.push_back(static_cast<uint32_t>(to));
+  }
+  std::stable_sort(_ratioOrder.begin(), _ratioOrder.end(),
+      [this, prizes](uint32_t a, uint32_t b) {
+        return prizes[a] * _leastTimes[b] > prizes[b] * _leastTimes[a];
+      });
+  _incumbent = greedyPrize();
+}
+
+// _____________________________________________________________________________
+size_t FptSolver::greedyPrize() const {
+  size_t nodesNum = _graph->getNodesNum();
+  const size_t* releases = _graph->getReleases()->data();
+  const size_t* deadlines = _graph->getDeadlines()->data();
+  const size_t* durations = _graph->getDurations()->data();
+  const size_t* prizes = _graph->getPrizes()->data();
+  const uint32_t* columns = _graph->matrixColumns();
+  size_t bestPrize = 0;
+  for (size_t start = 1; start < nodesNum; start++) {
+    if (!_index->servable(start)) {continue;}
+    JobSet visited {start};
+    size_t job = start;
+    double time = releases[start];
+    size_t prize = prizes[start];
+    while (true) {
+      double leave = time + durations[job];
+      const double* distances = _graph->matrixRow(job);
+      size_t next = 0;
+      double nextTime = 0;
+      double nextSpent = 0;
+      for (size_t successor = 1; successor < nodesNum; successor++) {
+        if (visited.count(successor) != 0) {continue;}
+        size_t column = columns == nullptr ? successor : columns[successor];
+        double arrival = leave + distances[column];
+        if (arrival + durations[successor] > deadlines[successor]) {
+          continue;
+        }
+        double serviceStart = std::max(
+            static_cast<double>(releases[successor]), arrival);
+        double spent = serviceStart + durations[successor] - leave;
+        // compare prize per time spent without dividing by zero.
+        if (next == 0 || prizes[successor] * nextSpent
+                         > prizes[next] * spent) {
+          next = successor;
+          nextTime = serviceStart;
+          nextSpent = spent;
+        }
+      }
+      if (next == 0) {break;}
+      visited.insert(next);
+      prize += prizes[next];
+      job = next;
+      time = nextTime;
+    }
+    bestPrize = std::max(bestPrize, prize);
+  }
+  return bestPrize;
+}
+
+// _____________________________________________________________________________
+size_t FptSolver::bound(const Constraint &constr, const size_t job) const {
+  return bound(constr.time, constr.revenue,
+               _prohibSets.get(constr.prohibJobs), job);
+}
+
+// _____________________________________________________________________________
+size_t FptSolver::bound(const uint32_t label) const {
+  return bound(_labels.time(label), _labels.revenue(label),
+               _prohibSets.get(_labels.prohibJobs(label)), _labels.job(label));
+}
+
+// _____________________________________________________________________________
+size_t FptSolver::bound(const double time, const size_t revenueSoFar,
+                        const JobSet &prohibJobs, const size_t job) const {
+  size_t nodesNum = _graph->getNodesNum();
+  const double* sorted = &_sortedStarts[job * nodesNum];
+  const double* latest = &_latestStarts[job * nodesNum];
+  // number of nodes that can still be served after starting job at time.
+  size_t reachable = std::lower_bound(sorted, sorted + nodesNum, time,
+      [](double start, double t) { return start >= t; }) - sorted;
+  size_t revenue = revenueSoFar + _prizeSums[job * (nodesNum + 1)
+                                             + reachable];
+  // prohibited jobs, job itself among them, are not collected again.
+  const size_t* prizes = _graph->getPrizes()->data();
+  for (auto tourJob : prohibJobs) {
+    if (latest[tourJob] >= time) {
+      revenue -= prizes[tourJob];
     }
-    _constraints.push_back(level);
   }
+  return revenue;
+}
 
-  // initialise constraints at first level.
+// _____________________________________________________________________________
+size_t FptSolver::timeBound(const double time, const size_t revenueSoFar,
+                            const JobSet &prohibJobs, const size_t job) const {
+  size_t nodesNum = _graph->getNodesNum();
+  const double* latest = &_latestStarts[job * nodesNum];
+  const size_t* deadlines = _graph->getDeadlines()->data();
+  const size_t* prizes = _graph->getPrizes()->data();
+  double leave = time + _graph->getDurations()->at(job);
+  // the jobs that can still be served end by the latest of their
+  // deadlines.
+  double end = leave;
+  for (uint32_t next : _ratioOrder) {
+    if (latest[next] >= time && prohibJobs.count(next) == 0) {
+      end = std::max(end, static_cast<double>(deadlines[next]));
+    }
+  }
+  double capacity = end - leave;
+  double revenue = 0;
+  for (uint32_t next : _ratioOrder) {
+    if (latest[next] < time || prohibJobs.count(next) != 0) {continue;}
+    if (_leastTimes[next] <= capacity) {
+      capacity -= _leastTimes[next];
+      revenue += prizes[next];
+    } else {
+      revenue += prizes[next] * capacity / _leastTimes[next];
+      break;
+    }
+  }
+  // a small slack keeps the bound optimistic despite rounding.
+  size_t knapsack = revenueSoFar + static_cast<size_t>(revenue + 1e-6);
+  return std::min(knapsack, bound(time, revenueSoFar, prohibJobs, job));
+}
+
+// _____________________________________________________________________________
+void FptSolver::closeFronts(LabelArena *labels) {
+  for (size_t job = 0; job < _fronts.size(); job++) {
+    for (const auto &constr : _fronts[job]) {
+      labels->add(static_cast<uint32_t>(job), constr.time, constr.revenue,
+                  constr.predecessor, constr.prohibJobs);
+    }
+    _fronts[job].clear();
+  }
+  labels->closeLevel();
+}
+
+// _____________________________________________________________________________
+void FptSolver::dropExpandedSets() {
+  const uint32_t none = static_cast<uint32_t>(-1);
+  // the new id of every set after the pinned ones that a front uses.
+  vector<uint32_t> newIds(_prohibSets.size() - _pinnedSets, none);
+  vector<JobSet> kept;
+  for (auto &front : _fronts) {
+    for (auto &constr : front) {
+      if (constr.prohibJobs < _pinnedSets) {continue;}
+      uint32_t &id = newIds[constr.prohibJobs - _pinnedSets];
+      if (id == none) {
+        id = static_cast<uint32_t>(_pinnedSets + kept.size());
+        kept.push_back(_prohibSets.get(constr.prohibJobs));
+      }
+      constr.prohibJobs = id;
+    }
+  }
+  // the kept sets differ from the pinned ones, so they are interned
+  // with the ids given to them above.
+  _prohibSets.truncate(_pinnedSets);
+  for (const auto &set : kept) {
+    _prohibSets.intern(set);
+  }
+}
+
+// _____________________________________________________________________________
+void FptSolver::initConstraints() {
+  size_t dimension = _graph->getNodesNum();
+  // the start node is the root of all tours in the arena.
+  _labels.reset(dimension);
+  _prohibSets.clear();
+  _fronts.assign(dimension, {});
+
+  // initialise constraints at first level, jobs that do not fit into
+  // their time window are never visited.
   for (size_t node = 1; node < dimension; node++) {
-    auto time = static_cast<double>(_graph.getReleases()->at(node));
-    size_t revenue = _graph.getPrizes()->at(node);
-    tuple<size_t, size_t> pred {0, 0};
-    set<size_t> prohibJ = {node};
-    Constraint constr = {time, revenue, pred, prohibJ};
-    _constraints[1][node].push_back(constr);
+    if (!_index->servable(node)) {continue;}
+    double time = _index->earliestStart(node);
+    size_t revenue = _graph->getPrizes()->at(node);
+    Constraint constr = {time, revenue, 0, _prohibSets.intern({node})};
+    _fronts[node].push_back(constr);
+  }
+  closeFronts(&_labels);
+}
+
+// _____________________________________________________________________________
+tuple<size_t, tuple<size_t, size_t, size_t>, FptStats> FptSolver::solve() {
+  if (_options.ngSize == 0) {
+    return solveLevels();
+  }
+  initNeighbourhoods();
+  FptStats total;
+  while (true) {
+    auto result = solveLevels();
+    total.add(std::get<2>(result));
+    FPT_COUNT(total.relaxedSolves++);
+    std::get<2>(result) = total;
+    vector<Location> tour;
+    if (std::get<1>(std::get<1>(result)) != 0) {
+      tour = getTour(std::get<1>(result));
+    }
+    // the first job that was visited before.
+    size_t repeat = 1;
+    while (repeat < tour.size()
+           && std::none_of(tour.begin(), tour.begin() + repeat,
+                           [&tour, repeat](const Location &loc) {
+                             return loc.id == tour[repeat].id;
+                           })) {
+      repeat++;
+    }
+    if (repeat >= tour.size()) {
+      return result;
+    }
+    // out of budget, the part before the repetition is a valid tour.
+    if (_stopped) {
+      size_t prize = 0;
+      for (size_t i = 0; i < repeat; i++) {
+        prize += tour[i].prize;
+      }
+      return std::make_tuple(prize, ancestor(std::get<1>(result),
+                                             tour.size() - repeat),
+                             total);
+    }
+    // with all neighbourhoods complete the search is not relaxed.
+    if (!growNeighbourhoods(tour)) {
+      return result;
+    }
   }
 }
 
 // _____________________________________________________________________________
-tuple<size_t, tuple<size_t, size_t, size_t>> FptSolver::solve() {
+tuple<size_t, tuple<size_t, size_t, size_t>, FptStats>
+FptSolver::solveLevels() {
   initConstraints();
+  if (_options.pruneByBound || _options.beamWidth > 0) {
+    initBounds();
+  }
+  _stopped = false;
+  _stats = FptStats();
+  _upperBound = 0;
   size_t max_prize = 0;
-  // to remember the (level, node_id, constraint_id) of the so far best tour.
+  // to remember the (level, node_id, label) of the so far best tour.
   tuple<size_t, size_t, size_t>  bestTourEnd(1, 0, 0);
+  _joinedEnd = std::make_tuple(0, 0, 0);
+  _joinedStart = std::make_tuple(0, 0, 0);
+  if (_options.bidirectional) {
+    // the best backward label alone is a tour without a forward part.
+    max_prize = solveBackward();
+    if (max_prize > 0) {
+      bestTourEnd = _joinedEnd;
+    }
+    _incumbent = std::max(_incumbent, max_prize);
+  }
+  _pinnedSets = _prohibSets.size();
   bool done = false;  // to check if there is any continuation.
-  size_t nodesNum = _graph.getNodesNum();
+  size_t nodesNum = _graph->getNodesNum();
+  std::unique_ptr<ThreadPool> pool;
+  if (_options.threads > 1) {
+    pool.reset(new ThreadPool(_options.threads));
+  }
 
   // different levels.
   for (size_t level = 1; level < nodesNum; level++) {
     if (done) {break;}
-    done = true;
 
     // for all all jobs at current level.
-    for (size_t job = 1; job < nodesNum; job++) {
-      // check constraints for continuation of a tour.
-      size_t constrId = 0;
-      for (auto constr : _constraints[level][job]) {
-        size_t prize = constr.revenue;
-        if (prize > max_prize) {
-          max_prize = prize;
-          std::get<0>(bestTourEnd) = level;
-          std::get<1>(bestTourEnd) = job;
-          std::get<2>(bestTourEnd) = constrId;
-        }
-        // all jobs at next level.
-        for (size_t successor = 1; successor < nodesNum; successor++) {
-          if (constr.prohibJobs.count(successor) != 0) {continue;}
-          double timeAtNext = constr.time
-              + static_cast<double>(_graph.getDurations()->at(job))
-              + (_graph.getDistances()->at(job))[successor]
-              + static_cast<double>(_graph.getDurations()->at(successor));
-
-          set<size_t> newProhib {successor};
-          size_t deadline = _graph.getDeadlines()->at(successor);
-          if (timeAtNext > static_cast<double>(deadline)) {
-            continue;
-          }
-          // check if new job has to be added to prohibited Jobs.
-          for (auto tourJob : constr.prohibJobs) {
-            if (checkProhibited(successor, tourJob, timeAtNext)) {
-              newProhib.insert(tourJob);
-            }
+    scanLevel(level, &max_prize, &bestTourEnd);
+    // out of budget, the partial level has just been checked for a
+    // better tour.
+    if (_stopped) {break;}
+    // tours visit at most every job once, relaxed tours are cut there.
+    if (level + 1 == nodesNum) {break;}
+
+    // check constraints for continuation of a tour.
+    if (pool) {
+      done = !expandLevelParallel(level, pool.get());
+    } else {
+      done = !expandLevel(level);
+    }
+    if (_options.beamWidth > 0) {
+      trimFronts();
+    }
+    if (_options.rollingLevels) {
+      dropExpandedSets();
+    }
+    closeFronts(&_labels);
+    if (_options.rollingLevels) {
+      _labels.release(level + 1);
+    }
+  }
+  // a stopped search only knows the bound of all tours.
+  if (_stopped) {
+    _upperBound = std::max(_upperBound, rootBound());
+  }
+  _upperBound = std::max(_upperBound, max_prize);
+  return std::make_tuple(max_prize, bestTourEnd, _stats);
+}
+
+// _____________________________________________________________________________
+size_t FptSolver::upperBound() const {
+  return _upperBound;
+}
+
+// _____________________________________________________________________________
+size_t FptSolver::rootBound() const {
+  size_t nodesNum = _graph->getNodesNum();
+  const size_t* prizes = _graph->getPrizes()->data();
+  size_t best = 0;
+  for (size_t job = 1; job < nodesNum; job++) {
+    if (!_index->servable(job)) {continue;}
+    if (_latestStarts.empty()) {
+      best += prizes[job];
+    } else {
+      best = std::max(best, timeBound(_index->earliestStart(job),
+                                      prizes[job], JobSet({job}), job));
+    }
+  }
+  return best;
+}
+
+// _____________________________________________________________________________
+void FptSolver::trimFronts() {
+  size_t nodesNum = _graph->getNodesNum();
+  size_t width = _options.beamWidth;
+  vector<size_t> bounds;
+  vector<size_t> order;
+  vector<char> keep;
+  for (size_t job = 1; job < nodesNum; job++) {
+    vector<Constraint> &front = _fronts[job];
+    if (front.size() <= width) {continue;}
+    bounds.resize(front.size());
+    order.resize(front.size());
+    for (size_t i = 0; i < front.size(); i++) {
+      bounds[i] = bound(front[i], job);
+      order[i] = i;
+    }
+    // the best labels first, the earlier start with more slack breaks
+    // ties, which is the order of the front.
+    std::nth_element(order.begin(), order.begin() + width, order.end(),
+        [&bounds, &front](size_t a, size_t b) {
+          if (bounds[a] != bounds[b]) {return bounds[a] > bounds[b];}
+          if (front[a].revenue != front[b].revenue) {
+            return front[a].revenue > front[b].revenue;
           }
-          done = false;  // a continuation is possible;
-
-          size_t newPrize = constr.revenue + _graph.getPrizes()->at(successor);
-          auto sucRelease = static_cast<double>(_graph.getReleases()
-                                               ->at(successor));
-          auto duration = static_cast<double>(_graph.getDurations()->at(job));
-          double travelTime = _graph.getDistances()->at(job)[successor];
-          double newTime = std::max(sucRelease, constr.time
-                                   + duration + travelTime);
-
-          tuple<size_t , size_t > predecessor {job, constrId};
-          Constraint newConstr = {newTime, newPrize, predecessor, newProhib};
-          updateConstraints(newConstr, level + 1, successor);
+          return a < b;
+        });
+    keep.assign(front.size(), 0);
+    for (size_t i = 0; i < width; i++) {
+      keep[order[i]] = 1;
+    }
+    // the cheap bound decides whether the time bound can raise it.
+    for (size_t i = width; i < order.size(); i++) {
+      const Constraint &dropped = front[order[i]];
+      if (bounds[order[i]] > _upperBound) {
+        _upperBound = std::max(_upperBound, timeBound(dropped.time,
+            dropped.revenue, _prohibSets.get(dropped.prohibJobs), job));
+      }
+    }
+    FPT_COUNT(_stats.trimmed += front.size() - width);
+    // the kept labels stay sorted by time.
+    size_t kept = 0;
+    for (size_t i = 0; i < front.size(); i++) {
+      if (keep[i]) {
+        if (kept != i) {
+          front[kept] = std::move(front[i]);
         }
-        constrId++;
+        kept++;
+      }
+    }
+    front.resize(width);
+  }
+}
+
+// _____________________________________________________________________________
+void FptSolver::scanLevel(const size_t level, size_t *maxPrize,
+                          tuple<size_t, size_t, size_t> *bestTourEnd) {
+  bool improved = false;
+  size_t nodesNum = _graph->getNodesNum();
+  FPT_COUNT(_stats.levelLabels.resize(level + 1, 0);
+            _stats.levelLabels[level] += _labels.levelEnd(level)
+                                         - _labels.levelBegin(level));
+  for (size_t job = 1; job < nodesNum; job++) {
+    FPT_COUNT(_stats.widestFront = std::max<size_t>(_stats.widestFront,
+                  _labels.cellEnd(level, job) - _labels.cellBegin(level, job)));
+  }
+  for (uint32_t label = _labels.levelBegin(level);
+       label < _labels.levelEnd(level); label++) {
+    FPT_COUNT(_stats.labels++;
+              _stats.prohibSum
+                  += _prohibSets.get(_labels.prohibJobs(label)).size());
+    size_t prize = _labels.revenue(label);
+    // the best tour continuing with a backward label.
+    tuple<size_t, size_t, size_t> joinedStart(0, 0, 0);
+    if (_options.bidirectional) {
+      size_t joined = bestJoin(label, std::max(prize, *maxPrize),
+                               &joinedStart);
+      prize = std::max(prize, joined);
+    }
+    if (prize > *maxPrize) {
+      *maxPrize = prize;
+      std::get<0>(*bestTourEnd) = level;
+      std::get<1>(*bestTourEnd) = _labels.job(label);
+      std::get<2>(*bestTourEnd) = label;
+      _joinedEnd = *bestTourEnd;
+      _joinedStart = joinedStart;
+      _incumbent = std::max(_incumbent, prize);
+      improved = true;
+    }
+  }
+  if (improved && _onImprovement) {
+    _onImprovement(*maxPrize, getTour(*bestTourEnd));
+  }
+}
+
+// _____________________________________________________________________________
+template <typename Emit>
+bool FptSolver::expandConstraint(const uint32_t label, FptStats *stats,
+                                 Emit emit) const {
+  bool continued = false;
+  size_t nodesNum = _graph->getNodesNum();
+  const size_t* releases = _graph->getReleases()->data();
+  const size_t* deadlines = _graph->getDeadlines()->data();
+  const size_t* durations = _graph->getDurations()->data();
+  const size_t* prizes = _graph->getPrizes()->data();
+  size_t job = _labels.job(label);
+  double time = _labels.time(label);
+  size_t revenue = _labels.revenue(label);
+  double leave = time + static_cast<double>(durations[job]);
+  const JobSet &prohibJobs = _prohibSets.get(_labels.prohibJobs(label));
+  // the prohibited jobs of the continuations, interned only if they
+  // are inserted, so one set is reused for all of them.
+  JobSet newProhib;
+  // the incumbent may have improved since the label was generated.
+  if (_options.pruneByBound
+      && bound(time, revenue, prohibJobs, job) < _incumbent) {
+    FPT_COUNT(stats->pruned++);
+    return false;
+  }
+  // later starts are continued by the backward labels.
+  if (_options.bidirectional && time > _midpoint) {
+    return false;
+  }
+
+  // the distances from job are read from its matrix row, sub-instances
+  // map the successors to the columns of the full matrix.
+  const double* distances = _graph->matrixRow(job);
+  const uint32_t* columns = _graph->matrixColumns();
+
+  // all jobs at next level that can follow job at all. They are sorted
+  // by their latest leave, so the loop stops at the first successor
+  // that can no longer be reached in time.
+  size_t numSuccessors = _index->numSuccessors(job);
+  const uint32_t* successors = _index->successors(job);
+  const double* latestLeaves = _index->latestLeaves(job);
+  for (size_t i = 0; i < numSuccessors; i++) {
+    if (leave > latestLeaves[i]) {
+      FPT_COUNT(stats->deadlineMisses += numSuccessors - i);
+      break;
+    }
+    size_t successor = successors[i];
+    if (prohibJobs.count(successor) != 0) {continue;}
+    size_t column = columns == nullptr ? successor : columns[successor];
+    double travelTime = distances[column];
+    double timeAtNext = leave + travelTime
+        + static_cast<double>(durations[successor]);
+
+    if (timeAtNext > static_cast<double>(deadlines[successor])) {
+      FPT_COUNT(stats->deadlineMisses++);
+      continue;
+    }
+    // check which jobs stay prohibited, using the thresholds of the
+    // successor instead of calling checkProhibited for every job.
+    const double* thresholds = &_prohibThresholds[successor * nodesNum];
+    prohibJobs.filterInto(
+        [thresholds, timeAtNext](size_t tourJob) {
+          return timeAtNext <= thresholds[tourJob];
+        }, &newProhib);
+    // the relaxed state forgets the jobs outside the neighbourhood.
+    if (_options.ngSize > 0) {
+      newProhib.intersectWith(_ngSets[successor]);
+    }
+    newProhib.insert(successor);
+
+    size_t newPrize = revenue + prizes[successor];
+    auto sucRelease = static_cast<double>(releases[successor]);
+    double newTime = std::max(sucRelease, leave + travelTime);
+
+    Constraint newConstr = {newTime, newPrize, label, 0};
+    FPT_COUNT(stats->generated++);
+    if (_options.pruneByBound
+        && bound(newTime, newPrize, newProhib, successor) < _incumbent) {
+      FPT_COUNT(stats->pruned++);
+      continue;
+    }
+    continued = true;  // a continuation is possible;
+    emit(successor, newConstr, newProhib);
+  }
+  return continued;
+}
+
+// _____________________________________________________________________________
+bool FptSolver::expandLevel(const size_t level) {
+  bool continued = false;
+  for (uint32_t label = _labels.levelBegin(level);
+       label < _labels.levelEnd(level); label++) {
+    if (outOfBudget()) {
+      _stopped = true;
+      return continued;
+    }
+    continued |= expandConstraint(label, &_stats,
+        [this](size_t successor, Constraint &newConstr,
+               const JobSet &prohibJobs) {
+          updateConstraints(std::move(newConstr), prohibJobs, successor,
+                            &_stats);
+        });
+  }
+  return continued;
+}
+
+// _____________________________________________________________________________
+bool FptSolver::expandLevelParallel(const size_t level, ThreadPool *pool) {
+  size_t nodesNum = _graph->getNodesNum();
+  // the labels of the level in sequential order.
+  uint32_t begin = _labels.levelBegin(level);
+  size_t numLabels = _labels.levelEnd(level) - begin;
+  if (numLabels == 0) {
+    return false;
+  }
+
+  // every chunk of consecutive labels gets its own candidate buffer
+  // per successor. More chunks than threads balance the load. The
+  // candidates keep their prohibited jobs until they are interned.
+  size_t numChunks = std::min(numLabels, 4 * pool->size());
+  vector<vector<vector<tuple<Constraint, JobSet>>>> buffers(numChunks,
+      vector<vector<tuple<Constraint, JobSet>>>(nodesNum));
+  vector<char> continued(numChunks, 0);
+  vector<char> stopped(numChunks, 0);
+  // the effort is counted per chunk and per successor cell.
+  vector<FptStats> chunkStats(numChunks);
+  vector<FptStats> cellStats(nodesNum);
+  pool->run(numChunks, [&](size_t chunk) {
+    size_t first = begin + numLabels * chunk / numChunks;
+    size_t last = begin + numLabels * (chunk + 1) / numChunks;
+    vector<vector<tuple<Constraint, JobSet>>> &buffer = buffers[chunk];
+    for (size_t label = first; label < last; label++) {
+      if (outOfBudget()) {
+        stopped[chunk] = 1;
+        break;
+      }
+      if (expandConstraint(static_cast<uint32_t>(label), &chunkStats[chunk],
+          [&buffer](size_t successor, Constraint &newConstr,
+                    const JobSet &prohibJobs) {
+            buffer[successor].push_back(std::make_tuple(newConstr,
+                                                        prohibJobs));
+          })) {
+        continued[chunk] = 1;
+      }
+    }
+  });
+
+  // merge the buffers per successor front in chunk order, which is the
+  // order the sequential expansion inserts them. The fronts are still
+  // empty, so each front is built with its own sets and only the sets
+  // of its labels are interned afterwards.
+  vector<vector<JobSet>> frontSets(nodesNum);
+  pool->run(nodesNum, [&](size_t successor) {
+    vector<JobSet> &sets = frontSets[successor];
+    auto setOf = [&sets](const Constraint &constr) -> const JobSet & {
+      return sets[constr.prohibJobs];
+    };
+    auto intern = [&sets](const JobSet &prohibJobs) {
+      sets.push_back(prohibJobs);
+      return static_cast<uint32_t>(sets.size() - 1);
+    };
+    for (auto &buffer : buffers) {
+      for (auto &candidate : buffer[successor]) {
+        insertLabel(&_fronts[successor],
+                    std::move(std::get<0>(candidate)), std::get<1>(candidate),
+                    setOf, intern, &cellStats[successor]);
       }
     }
+  });
+  for (size_t successor = 0; successor < nodesNum; successor++) {
+    for (auto &constr : _fronts[successor]) {
+      constr.prohibJobs
+          = _prohibSets.intern(frontSets[successor][constr.prohibJobs]);
+    }
   }
-  return std::make_tuple(max_prize, bestTourEnd);
+  _stopped = std::find(stopped.begin(), stopped.end(), 1) != stopped.end();
+  FPT_COUNT(for (const auto &stats : chunkStats) { _stats.add(stats); }
+            for (const auto &stats : cellStats) { _stats.add(stats); });
+  return std::find(continued.begin(), continued.end(), 1) != continued.end();
 }
 
 // _____________________________________________________________________________
-bool FptSolver::checkProhibited(const size_t node1, const size_t node2,
-                                const double time) const {
-  auto release = static_cast<double>(_graph.getReleases()->at(node1));
-  auto duration1 = static_cast<double>(_graph.getDurations()->at(node1));
-  auto duration2 = static_cast<double>(_graph.getDurations()->at(node2));
-  double earliestStart = std::max(time, release + duration1);
-  double travelTime = _graph.getDistances()->at(node1)[node2];
-  double deadline = _graph.getDeadlines()->at(node2);
-  return earliestStart + travelTime + duration2 <= deadline;
+size_t FptSolver::solveBackward() {
+  size_t nodesNum = _graph->getNodesNum();
+  const size_t* prizes = _graph->getPrizes()->data();
+  // the midpoint is the median of the window centres, so that about
+  // as many jobs are served before it as after it.
+  vector<double> centres;
+  for (size_t job = 1; job < nodesNum; job++) {
+    if (_index->servable(job)) {
+      centres.push_back((_index->earliestStart(job) + _index->latestStart(job))
+                        / 2);
+    }
+  }
+  _midpoint = 0.0;
+  if (!centres.empty()) {
+    std::nth_element(centres.begin(), centres.begin() + centres.size() / 2,
+                     centres.end());
+    _midpoint = centres[centres.size() / 2];
+  }
+
+  // the first backward level holds the last job of every tour, which
+  // starts at its latest start.
+  _backwardLabels.reset(nodesNum);
+  for (size_t job = 1; job < nodesNum; job++) {
+    if (!_index->servable(job)) {continue;}
+    Constraint constr = {-_index->latestStart(job), prizes[job], 0,
+                         _prohibSets.intern({job})};
+    _fronts[job].push_back(constr);
+  }
+  closeFronts(&_backwardLabels);
+  for (size_t level = 1; level + 1 < nodesNum && !_stopped; level++) {
+    bool continued = false;
+    for (uint32_t label = _backwardLabels.levelBegin(level);
+         label < _backwardLabels.levelEnd(level); label++) {
+      if (outOfBudget()) {
+        _stopped = true;
+        break;
+      }
+      continued |= expandBackward(label);
+    }
+    closeFronts(&_backwardLabels);
+    if (!continued) {break;}
+  }
+
+  // the labels of every job by decreasing revenue for the joins.
+  size_t best = 0;
+  _joinOrder.assign(nodesNum, {});
+  for (size_t level = 1; level < _backwardLabels.numLevels(); level++) {
+    FPT_COUNT(_stats.backwardLabels += _backwardLabels.levelEnd(level)
+                                       - _backwardLabels.levelBegin(level));
+    for (uint32_t label = _backwardLabels.levelBegin(level);
+         label < _backwardLabels.levelEnd(level); label++) {
+      size_t job = _backwardLabels.job(label);
+      _joinOrder[job].push_back(label);
+      if (_backwardLabels.revenue(label) > best) {
+        best = _backwardLabels.revenue(label);
+        _joinedStart = std::make_tuple(level, job, label);
+      }
+    }
+  }
+  for (size_t job = 1; job < nodesNum; job++) {
+    std::stable_sort(_joinOrder[job].begin(), _joinOrder[job].end(),
+        [this](uint32_t a, uint32_t b) {
+          return _backwardLabels.revenue(a) > _backwardLabels.revenue(b);
+        });
+  }
+  return best;
 }
 
 // _____________________________________________________________________________
-void FptSolver::updateConstraints(Constraint newConstr, const size_t row,
-                                  const size_t col) {
-  bool newisGood = true;
-  vector<Constraint> updatedCons;
-  for (auto constr : _constraints[row][col]) {
-    if (!(constr > newConstr)) {
-      updatedCons.push_back(constr);
+bool FptSolver::expandBackward(const uint32_t label) {
+  double latest = -_backwardLabels.time(label);
+  // earlier starts are continued by the forward labels.
+  if (latest <= _midpoint) {
+    return false;
+  }
+  const size_t* releases = _graph->getReleases()->data();
+  const size_t* durations = _graph->getDurations()->data();
+  const size_t* prizes = _graph->getPrizes()->data();
+  // a small slack keeps jobs prohibited despite rounding.
+  const double slack = 1e-6;
+  bool continued = false;
+  size_t job = _backwardLabels.job(label);
+  const JobSet &prohibJobs = _prohibSets.get(_backwardLabels.prohibJobs(label));
+  JobSet newProhib;
+
+  // the predecessors are sorted by the time they reach job at the
+  // earliest, the loop stops at the first one that is too late.
+  size_t numPredecessors = _index->numPredecessors(job);
+  const uint32_t* predecessors = _index->predecessors(job);
+  const double* arrivals = _index->earliestArrivals(job);
+  for (size_t i = 0; i < numPredecessors; i++) {
+    if (latest < arrivals[i]) {
+      FPT_COUNT(_stats.deadlineMisses += numPredecessors - i);
+      break;
+    }
+    size_t pred = predecessors[i];
+    if (prohibJobs.count(pred) != 0) {continue;}
+    double travelTime = _graph->distance(pred, job);
+    double predLatest = std::min(_index->latestStart(pred),
+        latest - travelTime - static_cast<double>(durations[pred]));
+    if (predLatest < static_cast<double>(releases[pred])) {
+      FPT_COUNT(_stats.deadlineMisses++);
+      continue;
     }
+    // jobs of the tour stay prohibited if they could still be served
+    // before pred.
+    prohibJobs.filterInto(
+        [this, releases, durations, pred, predLatest, slack](size_t tourJob) {
+          return releases[tourJob] + static_cast<double>(durations[tourJob])
+                 + _graph->distance(tourJob, pred) <= predLatest + slack;
+        }, &newProhib);
+    newProhib.insert(pred);
+
+    Constraint newConstr = {-predLatest,
+                            _backwardLabels.revenue(label) + prizes[pred],
+                            label, 0};
+    FPT_COUNT(_stats.generated++);
+    continued = true;
+    insertPooled(&_fronts[pred], std::move(newConstr), newProhib, &_stats);
   }
-  for (const auto &constr : updatedCons) {
-    if (newConstr > constr) {
-      newisGood = false;
+  return continued;
+}
+
+// _____________________________________________________________________________
+size_t FptSolver::bestJoin(const uint32_t label, const size_t minRevenue,
+                           tuple<size_t, size_t, size_t> *start) const {
+  const size_t* releases = _graph->getReleases()->data();
+  const size_t* durations = _graph->getDurations()->data();
+  size_t job = _labels.job(label);
+  size_t revenue = _labels.revenue(label);
+  uint32_t prohibJobs = _labels.prohibJobs(label);
+  double leave = _labels.time(label) + static_cast<double>(durations[job]);
+  size_t best = minRevenue;
+  const double* distances = _graph->matrixRow(job);
+  const uint32_t* columns = _graph->matrixColumns();
+  size_t numSuccessors = _index->numSuccessors(job);
+  const uint32_t* successors = _index->successors(job);
+  const double* latestLeaves = _index->latestLeaves(job);
+  for (size_t i = 0; i < numSuccessors; i++) {
+    if (leave > latestLeaves[i]) {break;}
+    size_t next = successors[i];
+    if (_prohibSets.get(prohibJobs).count(next) != 0) {continue;}
+    size_t column = columns == nullptr ? next : columns[next];
+    double arrival = std::max(static_cast<double>(releases[next]),
+                              leave + distances[column]);
+    // the first fitting label is the best one for next. Jobs that are
+    // in both tours are prohibited in both labels.
+    for (uint32_t backward : _joinOrder[next]) {
+      if (revenue + _backwardLabels.revenue(backward) <= best) {break;}
+      if (arrival > -_backwardLabels.time(backward)
+          || _prohibSets.intersects(prohibJobs,
+                                    _backwardLabels.prohibJobs(backward))) {
+        continue;
+      }
+      best = revenue + _backwardLabels.revenue(backward);
+      // the level of a backward label is the length of its tour.
+      size_t level = 0;
+      for (uint32_t step = backward; step != 0;
+           step = _backwardLabels.parent(step)) {
+        level++;
+      }
+      *start = std::make_tuple(level, next, backward);
       break;
     }
   }
-  if (newisGood) {
-    updatedCons.push_back(newConstr);
+  return best > minRevenue ? best : 0;
+}
+
+// _____________________________________________________________________________
+void FptSolver::initNeighbourhoods() {
+  size_t nodesNum = _graph->getNodesNum();
+  _ngSets.assign(nodesNum, JobSet());
+  vector<size_t> jobs;
+  for (size_t job = 1; job < nodesNum; job++) {
+    jobs.clear();
+    for (size_t other = 1; other < nodesNum; other++) {
+      if (other != job && _index->servable(other)) {
+        jobs.push_back(other);
+      }
+    }
+    size_t size = std::min(_options.ngSize, jobs.size());
+    std::partial_sort(jobs.begin(), jobs.begin() + size, jobs.end(),
+                      [this, job](size_t a, size_t b) {
+                        double toA = _graph->distance(job, a);
+                        double toB = _graph->distance(job, b);
+                        return toA < toB || (toA == toB && a < b);
+                      });
+    _ngSets[job].insert(job);
+    for (size_t i = 0; i < size; i++) {
+      _ngSets[job].insert(jobs[i]);
+    }
+  }
+}
+
+// _____________________________________________________________________________
+bool FptSolver::growNeighbourhoods(const vector<Location> &tour) {
+  bool grown = false;
+  for (size_t second = 1; second < tour.size(); second++) {
+    size_t job = tour[second].id;
+    // the latest earlier visit of the same job.
+    size_t first = second;
+    while (first > 0 && tour[first - 1].id != job) {
+      first--;
+    }
+    if (first == 0) {continue;}
+    for (size_t between = first; between < second; between++) {
+      JobSet &memory = _ngSets[tour[between].id];
+      if (memory.count(job) == 0) {
+        memory.insert(job);
+        grown = true;
+      }
+    }
+  }
+  // a cycle is always cut by the grown neighbourhoods, unless rounding
+  // kept a job out of the prohibited jobs. Then all jobs remember it.
+  if (!grown) {
+    for (const auto &loc : tour) {
+      for (auto &memory : _ngSets) {
+        grown |= memory.count(loc.id) == 0;
+        memory.insert(loc.id);
+      }
+    }
+  }
+  return grown;
+}
+
+// _____________________________________________________________________________
+tuple<size_t, size_t, size_t> FptSolver::ancestor(
+    tuple<size_t, size_t, size_t> tourEnd, const size_t steps) const {
+  uint32_t label = static_cast<uint32_t>(std::get<2>(tourEnd));
+  for (size_t step = 0; step < steps; step++) {
+    label = _labels.parent(label);
+  }
+  return std::make_tuple(std::get<0>(tourEnd) - steps, _labels.job(label),
+                         label);
+}
+
+// _____________________________________________________________________________
+void FptSolver::updateConstraints(Constraint newConstr,
+                                  const JobSet &prohibJobs, const size_t job,
+                                  FptStats *stats) {
+  insertPooled(&_fronts[job], std::move(newConstr), prohibJobs, stats);
+}
+
+// _____________________________________________________________________________
+void FptSolver::insertPooled(vector<Constraint> *front, Constraint newConstr,
+                             const JobSet &prohibJobs, FptStats *stats) {
+  insertLabel(front, std::move(newConstr), prohibJobs,
+      [this](const Constraint &constr) -> const JobSet & {
+        return _prohibSets.get(constr.prohibJobs);
+      },
+      [this](const JobSet &set) { return _prohibSets.intern(set); }, stats);
+}
+
+// _____________________________________________________________________________
+template <typename SetOf, typename Intern>
+void FptSolver::insertLabel(vector<Constraint> *cellFront,
+                            Constraint newConstr, const JobSet &prohibJobs,
+                            SetOf setOf, Intern intern, FptStats *stats) {
+  vector<Constraint> &front = *cellFront;
+  auto startsBefore = [](const Constraint &constr, double time) {
+    return constr.time < time;
+  };
+  auto startsAfter = [](double time, const Constraint &constr) {
+    return constr.time > time;
+  };
+
+  // remove the constraints made obsolete by the new one. They can only
+  // start at the same time or later, collect at most its revenue and
+  // prohibit at least its jobs.
+  auto first = std::lower_bound(front.begin(), front.end(), newConstr.time,
+                                startsBefore);
+  auto last = std::remove_if(first, front.end(),
+      [&newConstr, &prohibJobs, &setOf](const Constraint &constr) {
+        return constr.revenue <= newConstr.revenue
+               && prohibJobs.isSubsetOf(setOf(constr));
+      });
+  FPT_COUNT(if (stats != nullptr) {
+    stats->removedFromCell += front.end() - last;
+  });
+  front.erase(last, front.end());
+
+  // the new constraint can only be dominated by one starting earlier.
+  auto insertPos = std::upper_bound(front.begin(), front.end(),
+                                    newConstr.time, startsAfter);
+  for (auto it = front.begin(); it != insertPos; ++it) {
+    if (it->revenue >= newConstr.revenue
+        && setOf(*it).isSubsetOf(prohibJobs)) {
+      FPT_COUNT(if (stats != nullptr) { stats->dominatedOnInsert++; });
+      return;
+    }
   }
-  _constraints[row][col].swap(updatedCons);
+  newConstr.prohibJobs = intern(prohibJobs);
+  front.insert(insertPos, std::move(newConstr));
 }
 
 // _____________________________________________________________________________
 vector<Location> const FptSolver::getTour(tuple<size_t,
                                                 size_t, size_t> tourEnd) const {
   vector<Location> reversePath;
-  size_t level = std::get<0>(tourEnd);
-  size_t job = std::get<1>(tourEnd);
-  size_t constrId = std::get<2>(tourEnd);
-
-  while (level > 0) {
-    Constraint actualConstr = _constraints[level][job][constrId];
-    auto arrival = actualConstr.time;
-    auto leave = arrival + _graph.getDurations()->at(job);
-    auto prize = _graph.getPrizes()->at(job);
-    auto geoLoc = _graph.getLocations()->at(job);
+  // the parent links end at the root, the start node with handle 0.
+  uint32_t label = static_cast<uint32_t>(std::get<2>(tourEnd));
+  while (label != 0) {
+    size_t job = _labels.job(label);
+    double arrival = _labels.time(label);
+    auto leave = arrival + _graph->getDurations()->at(job);
+    auto prize = _graph->getPrizes()->at(job);
+    auto geoLoc = _graph->getLocations()->at(job);
     auto lat = std::get<0>(geoLoc);
     auto longit = std::get<1>(geoLoc);
-    auto  name = _graph.getNodeNames()->at(job);
+    auto  name = _graph->getNodeNames()->at(job);
     Location node = {job, prize, arrival, leave, lat, longit, name};
     reversePath.push_back(node);
 
     // get predecessor on the tour.
-    job = std::get<0>(actualConstr.predecessor);
-    constrId = std::get<1>(actualConstr.predecessor);
-    level--;
+    label = _labels.parent(label);
   }
 
   vector<Location> path;
@@ -186,5 +1128,28 @@ vector<Location> const FptSolver::getTour(tuple<size_t,
         path.push_back(loc);
     reversePath.pop_back();
   }
+
+  // the joined backward labels, each job starts as early as possible.
+  if (tourEnd != _joinedEnd || std::get<0>(_joinedStart) == 0) {
+    return path;
+  }
+  label = static_cast<uint32_t>(std::get<2>(_joinedStart));
+  size_t previous = path.empty() ? 0 : path.back().id;
+  double leave = path.empty() ? 0.0 : path.back().leave;
+  while (label != 0) {
+    size_t job = _backwardLabels.job(label);
+    double arrival = _graph->getReleases()->at(job);
+    if (previous != 0) {
+      arrival = std::max(arrival, leave + _graph->distance(previous, job));
+    }
+    leave = arrival + _graph->getDurations()->at(job);
+    auto geoLoc = _graph->getLocations()->at(job);
+    Location node = {job, _graph->getPrizes()->at(job), arrival, leave,
+                     std::get<0>(geoLoc), std::get<1>(geoLoc),
+                     _graph->getNodeNames()->at(job)};
+    path.push_back(node);
+    previous = job;
+    label = _backwardLabels.parent(label);
+  }
   return path;
 }
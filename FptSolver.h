@@ -6,70 +6,371 @@
 
 #include <gtest/gtest.h>
 #include "Graph.h"
-#include <set>
+#include "Instance.h"
+#include "JobSet.h"
+#include "JobSetPool.h"
+#include "LabelArena.h"
+#include "SuccessorIndex.h"
+#include "ThreadPool.h"
+#include <stdint.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <string>
 #include <tuple>
 #include <vector>
 
 using std::vector;
-using std::set;
 using std::string;
 using std::tuple;
 
-// Structure for a single constraint of a partial tour.
+// Structure for a single constraint of a partial tour, while the front
+// of its cell is built. Finished levels are kept in a LabelArena.
 struct Constraint {
   double time;
   size_t revenue;
-  tuple<size_t, size_t> predecessor;
-  set<size_t> prohibJobs;
-
-  // The > operator checks if a constraint is obsolete. It is
-  // not better than the new constraint starts earlier, has
-  // a larger revenue and its prohib set is contained in the
-  // constraints prohib set.
-  bool operator>(const Constraint &newConstr);
+  uint32_t predecessor;  // handle of the previous label in the arena.
+  uint32_t prohibJobs;  // id of the prohibited jobs in the JobSetPool.
 };
 
+// Options selecting how the FptSolver stores and expands constraints.
+struct FptOptions {
+  FptOptions();
+
+  // Only keep the labels of the last level in full. Once a level is
+  // expanded, its labels keep just their job, time and parent to follow
+  // tours, 16 bytes each, and their prohibited jobs are dropped from the
+  // pool. Memory then grows with the widest level instead of all levels.
+  bool rollingLevels;
+
+  // Number of threads expanding the constraints of a level. Each
+  // thread collects its continuations per successor and the buffers
+  // are merged cell by cell in the sequential order, so the result
+  // does not depend on the number of threads.
+  size_t threads;
+
+  // Discard constraints whose revenue plus the prizes of all jobs still
+  // reachable before their deadlines is below the best known tour. The
+  // best tour is seeded with a greedy tour. The optimum is still found.
+  bool pruneByBound;
+
+  // Grow labels from both ends of the tours and join them at a time
+  // midpoint. Forward labels are only continued while their job starts
+  // by the midpoint, backward labels, which start at the last job of a
+  // tour and hold the latest start of their first job, only while that
+  // start lies after the midpoint. Every tour is then the join of a
+  // forward and a backward label or found by one of them alone.
+  bool bidirectional;
+
+  // Decremental state-space relaxation if not 0. A label only remembers
+  // the visited jobs in the neighbourhood of its job, the ngSize jobs
+  // closest to it, so tours may visit a job again. The relaxed search
+  // is repeated, adding the jobs visited twice to the neighbourhoods of
+  // the jobs between the two visits, until its best tour is elementary
+  // and thus optimal. The search then runs forward without bounds, so
+  // bidirectional, pruneByBound and beamWidth are ignored.
+  size_t ngSize;
+
+  // Heuristic search keeping at most beamWidth labels per (level, job)
+  // cell if not 0. After a level is expanded, the labels of every cell
+  // of the next level are ranked by their bound, their revenue and
+  // their time, and the rest is dropped. The time and memory per level
+  // are then linear in the number of jobs. The largest timeBound of a
+  // dropped label is an upper bound on the prizes of the tours lost.
+  size_t beamWidth;
+};
+
+// Counting of the search effort. Compile with -DFPT_STATS=0 to leave
+// out all counting, the statistics then stay zero.
+#ifndef FPT_STATS
+#define FPT_STATS 1
+#endif
+
+// Search effort of a solve.
+struct FptStats {
+  FptStats();
+
+  size_t labels;  // labels that reached the scan of their level.
+  size_t generated;  // continuations built from expanded labels.
+  size_t deadlineMisses;  // successors skipped for their deadline.
+  size_t pruned;  // labels and continuations discarded by the bound.
+  size_t dominatedOnInsert;  // continuations dominated in their cell.
+  size_t removedFromCell;  // labels removed by a dominating continuation.
+  size_t widestFront;  // most labels in one (level, node) cell.
+  size_t prohibSum;  // total size of the prohibJobs of all labels.
+  size_t backwardLabels;  // labels of the backward search.
+  size_t relaxedSolves;  // searches of the state-space relaxation.
+  size_t trimmed;  // labels dropped by the beam.
+  vector<size_t> levelLabels;  // labels per level, index 0 is unused.
+
+  // Average size of the prohibJobs of a label.
+  double averageProhib() const;
+
+  // Adds the counters of other, the widest fronts are maximised.
+  void add(const FptStats &other);
+
+  bool operator==(const FptStats &other) const;
+};
+
+// Result of a budgeted solve.
+struct FptResult {
+  size_t prize;
+  vector<Location> tour;
+  // false if the search was stopped before it finished or the beam
+  // dropped a label that might have led to a better tour.
+  bool optimal;
+  size_t upperBound;  // upper bound on the prize of an optimal tour.
+  FptStats stats;
+};
+
+// Hook called with the prize and the tour of every improved solution.
+typedef std::function<void(size_t, const vector<Location>&)> ImprovementHook;
+
 // Class to solve PC_TW_TSP instance with a dynamic programming
 // approach as suggested by [Nebel, Renz].
 
 class FptSolver {
  public:
-  // Constructor taking a graph instance.
-  explicit FptSolver(Graph graph);
+  // Constructors taking a graph instance. Solvers of the same shared
+  // instance reuse its successor index and tables.
+  explicit FptSolver(Graph graph, FptOptions options = FptOptions());
+  explicit FptSolver(SharedInstance instance,
+                     FptOptions options = FptOptions());
+  FRIEND_TEST(FptSolverTest, sharedInstance);
 
-  // Algorithm computing the optimal tour.
-  tuple<size_t, tuple<size_t, size_t, size_t>> solve();
+  // Algorithm computing the optimal tour. Returns the prize, the end of
+  // the tour for getTour as (level, job, label handle) and the search
+  // effort.
+  tuple<size_t, tuple<size_t, size_t, size_t>, FptStats> solve();
   FRIEND_TEST(FptSolverTest, solve);
 
+  // Anytime version of solve. The search stops once timeLimit seconds
+  // have passed or *cancel becomes true, and the best tour found so far
+  // is returned. onImprovement is called after every level that found a
+  // better tour.
+  FptResult solveWithin(double timeLimit,
+                        const std::atomic<bool>* cancel = nullptr,
+                        ImprovementHook onImprovement = nullptr);
+  FRIEND_TEST(FptSolverTest, solveWithin);
+
+  // Upper bound on the optimal prize after solve. It equals the prize
+  // if the search was exact and finished.
+  size_t upperBound() const;
+
   // Method to compute the optimal tour for a solved instance
-  // by going backwards through constraints.
+  // by going backwards through constraints. In bidirectional mode the
+  // tour end returned by solve also continues with the backward labels
+  // it was joined with.
   vector<Location> const getTour(tuple<size_t, size_t, size_t > tourEnd) const;
   FRIEND_TEST(FptSolverTest, getTour);
+  FRIEND_TEST(FptSolverTest, labelArena);
+  FRIEND_TEST(FptSolverTest, rollingLevels);
+  FRIEND_TEST(FptSolverTest, parallelSolve);
+  FRIEND_TEST(FptSolverTest, stats);
+  FRIEND_TEST(FptSolverTest, bidirectional);
+  FRIEND_TEST(FptSolverTest, beam);
 
   // Destructor
   ~FptSolver();
 
  private:
-  Graph _graph;  // the graph to solve.
-  vector<vector<vector<Constraint>>> _constraints;
+  SharedInstance _instance;  // the instance to solve.
+  const Graph* _graph;  // the graph of _instance.
+  const SuccessorIndex* _index;  // windows and feasible successors.
+  FptOptions _options;
+  // The labels of all finished levels. Their handles stay valid for the
+  // whole solve, so parents and tour ends can always be followed.
+  LabelArena _labels;
+
+  // The non-dominated fronts of the level being built, by job. They are
+  // moved to an arena once the level is complete.
+  vector<vector<Constraint>> _fronts;
+
+  // Appends the fronts as the next level of labels and empties them.
+  void closeFronts(LabelArena *labels);
+
+  // The prohibited jobs of all labels of a solve. Labels in the same
+  // and neighbouring cells often prohibit the same jobs and then share
+  // one set. Only the inserted labels are interned, sequentially, the
+  // threads of a parallel expansion only read it.
+  JobSetPool _prohibSets;
+
+  // Number of sets of _prohibSets that are kept for the whole solve,
+  // those of the first level and of the backward labels.
+  size_t _pinnedSets;
+
+  // Removes the sets that only expanded levels use from _prohibSets, see
+  // rollingLevels. The fronts are renumbered to the remaining ids.
+  void dropExpandedSets();
+
+  // Budget of solveWithin, the deadline only applies if _hasDeadline.
+  std::chrono::steady_clock::time_point _deadline;
+  bool _hasDeadline;
+  const std::atomic<bool>* _cancel;
+  ImprovementHook _onImprovement;
+  bool _stopped;  // whether the last solve ran out of budget.
+  FptStats _stats;  // search effort of the running solve.
+
+  // One search over all levels, solve repeats it for the relaxation.
+  tuple<size_t, tuple<size_t, size_t, size_t>, FptStats> solveLevels();
+
+  // Neighbourhood of every job for the state-space relaxation, it
+  // contains the job itself.
+  vector<JobSet> _ngSets;
+
+  // Initial neighbourhoods of the closest ngSize jobs.
+  void initNeighbourhoods();
+
+  // Adds every job visited twice in tour to the neighbourhoods of the
+  // jobs visited in between. Returns false if nothing was added.
+  bool growNeighbourhoods(const vector<Location> &tour);
+  FRIEND_TEST(FptSolverTest, neighbourhoods);
+
+  // The tour end steps jobs before tourEnd on its tour.
+  tuple<size_t, size_t, size_t> ancestor(tuple<size_t, size_t, size_t> tourEnd,
+                                         size_t steps) const;
+
+  // Whether the deadline has passed or the search was cancelled. Only
+  // reads state, so the threads of a parallel expansion can call it.
+  bool outOfBudget() const;
+
+  // Checks all labels at a level for a better tour than the best one
+  // found so far.
+  void scanLevel(size_t level, size_t *maxPrize,
+                 tuple<size_t, size_t, size_t> *bestTourEnd);
+
+  // Computes all feasible continuations of a label and passes each one
+  // to emit(successor, constraint, prohibJobs), the prohibited jobs are
+  // left to the caller to intern. The effort is counted in stats.
+  // Returns whether there was any continuation.
+  template <typename Emit>
+  bool expandConstraint(uint32_t label, FptStats *stats, Emit emit) const;
+
+  // Expands all labels at a level into the fronts of the next level,
+  // either one after another or spread over the threads of a pool.
+  // Both return whether any continuation was found and set _stopped if
+  // they ran out of budget before all labels were expanded.
+  bool expandLevel(size_t level);
+  bool expandLevelParallel(size_t level, ThreadPool *pool);
 
   // Initialize a 2D field for the constraints.
   void initConstraints();
   FRIEND_TEST(FptSolverTest, initConstraints);
 
-  // Method to check whether node2 has to be added to prohibited
-  // jobs of a partial tour ending in node1.
-  bool checkProhibited(size_t node1, size_t node2, double time) const;
-  FRIEND_TEST(FptSolverTest, checkProhibited);
+  // The prohibition thresholds of the instance, see
+  // Instance::prohibThresholds.
+  const double* _prohibThresholds;
+
+  // Row-major table of the latest start of the service at node1 from
+  // which node2 can still be served in time, over all paths. Only
+  // computed when pruning by bound.
+  vector<double> _latestStarts;
+
+  // Rows of _latestStarts sorted in decreasing order, with the prefix
+  // sums of the prizes of the nodes in that order. A bound is then one
+  // binary search plus a correction for the prohibited jobs.
+  vector<double> _sortedStarts;
+  vector<size_t> _prizeSums;
+
+  // Prize of the best tour known so far, used for pruning.
+  size_t _incumbent;
+
+  // Computes the latest start tables and seeds the incumbent.
+  void initBounds();
+
+  // Prize of a greedy tour. Starting from every job it repeatedly
+  // visits the reachable job with the highest prize per time spent.
+  size_t greedyPrize() const;
+
+  // Optimistic bound on the revenue of any tour continuing constr,
+  // which ends at job, or a label of _labels.
+  size_t bound(const Constraint &constr, size_t job) const;
+  size_t bound(uint32_t label) const;
+  size_t bound(double time, size_t revenue, const JobSet &prohibJobs,
+               size_t job) const;
+
+  // Jobs by decreasing prize per least time they take, their service
+  // and the shortest travel to them, and these least times.
+  vector<uint32_t> _ratioOrder;
+  vector<double> _leastTimes;
+
+  // bound tightened by the time left. The jobs still to be served take
+  // at least their least time each and end by the latest deadline among
+  // them, so their prizes are at most a fractional knapsack over the
+  // time until then. Linear in the number of jobs.
+  size_t timeBound(double time, size_t revenue, const JobSet &prohibJobs,
+                   size_t job) const;
+
+  // Bound on the prize of any tour, the largest timeBound of a first
+  // job or the sum of all prizes without the bound tables.
+  size_t rootBound() const;
+
+  // Upper bound of the last solve, see upperBound().
+  size_t _upperBound;
+
+  // Keeps the beamWidth best labels of every front and raises
+  // _upperBound to the time bounds of the dropped ones.
+  void trimFronts();
+  FRIEND_TEST(FptSolverTest, pruneByBound);
+
+  // Backward labels by level and job. Their time is the negated latest
+  // start of the job, so that earlier times are better in both
+  // directions and the dominance test is shared. The parent of a
+  // backward label is the label of the next job of the tour.
+  LabelArena _backwardLabels;
+  double _midpoint;
+
+  // Handles of the backward labels of every job, by decreasing revenue.
+  vector<vector<uint32_t>> _joinOrder;
+
+  // The forward end of the best tour and the (level, job, handle) of the
+  // backward label it is joined with. Level 0 stands for no label.
+  tuple<size_t, size_t, size_t> _joinedEnd;
+  tuple<size_t, size_t, size_t> _joinedStart;
+
+  // Computes all backward labels. Returns the revenue of the best
+  // of them and stores it in _joinedStart.
+  size_t solveBackward();
+
+  // Continues a backward label with all predecessors into the fronts
+  // of the next backward level. Returns whether there was any
+  // continuation.
+  bool expandBackward(uint32_t label);
+
+  // Best backward label that continues a forward label with a revenue
+  // above minRevenue in total. Returns the total revenue, 0 if there is
+  // none, and the level, job and handle of the backward label.
+  size_t bestJoin(uint32_t label, size_t minRevenue,
+                  tuple<size_t, size_t, size_t> *start) const;
+
+  // Inserts newConstr with the prohibited jobs prohibJobs into a
+  // non-dominated front, see updateConstraints. setOf(label) returns the
+  // prohibited jobs of a label of the front and intern(prohibJobs) the
+  // id for newConstr, which is only asked for if it is inserted. Most
+  // continuations are dominated and never interned.
+  template <typename SetOf, typename Intern>
+  static void insertLabel(vector<Constraint> *front, Constraint newConstr,
+                          const JobSet &prohibJobs, SetOf setOf,
+                          Intern intern, FptStats *stats);
+
+  // insertLabel with the sets of _prohibSets.
+  void insertPooled(vector<Constraint> *front, Constraint newConstr,
+                    const JobSet &prohibJobs, FptStats *stats);
 
   // Updates the set of constraints for a partial tour.
-  // The constraints at row, col are updated.
-  // All constraints (t', P', revenue') in the set of constraints
-  // at idx (row, node) are removed if t <= t', P subset P' and
+  // The front of job is updated with newConstr, whose
+  // prohibited jobs are prohibJobs.
+  // All constraints (t', P', revenue') in the front
+  // are removed if t <= t', P subset P' and
   // revenue >= revenue'. Where (t, P, revenue) is the new Constraint).
-  void updateConstraints(Constraint newConstr, size_t row, size_t col);
+  // The constraints of a cell form a non-dominated front sorted by
+  // time, so only constraints not starting before the new one are
+  // checked for removal and only constraints not starting after it
+  // are checked for dominating it. Removal happens in place. Dominated
+  // and removed constraints are counted in stats if given.
+  void updateConstraints(Constraint newConstr, const JobSet &prohibJobs,
+                         size_t job, FptStats *stats = nullptr);
   FRIEND_TEST(FptSolverTest, updateConstraints);
 };
 
@@ -3,8 +3,9 @@
 
 #include <gtest/gtest.h>
 #include <iostream>
+#include <memory>
+#include <string>
 #include <tuple>
-#include <set>
 #include "./FptSolver.h"
 
 // _____________________________________________________________________________
@@ -13,31 +14,46 @@ TEST(FptSolverTest, initConstraints) {
   g.buildFromFile("test_data/example_graph2.graph", true);
   FptSolver solver = FptSolver(g);
   solver.initConstraints();
-  ASSERT_EQ(solver._constraints.size(), 3);
-  for (int i = 0; i < 3; i++) {
-    ASSERT_EQ(solver._constraints[i].size(), 3);
+  const LabelArena &labels = solver._labels;
+  ASSERT_EQ(labels.numLevels(), 2);
+  ASSERT_EQ(labels.cellEnd(1, 1) - labels.cellBegin(1, 1), 1);
+  uint32_t label1 = labels.cellBegin(1, 1);
+  ASSERT_EQ(labels.time(label1), 4);
+  ASSERT_EQ(labels.revenue(label1), 1);
+  ASSERT_EQ(labels.parent(label1), 0);
+  JobSet s1 = {1};
+  ASSERT_EQ(solver._prohibSets.get(labels.prohibJobs(label1)), s1);
+  uint32_t label2 = labels.cellBegin(1, 2);
+  ASSERT_EQ(labels.time(label2), 8);
+  ASSERT_EQ(labels.revenue(label2), 1);
+  ASSERT_EQ(labels.parent(label2), 0);
+  JobSet s = {2};
+  ASSERT_EQ(solver._prohibSets.get(labels.prohibJobs(label2)), s);
+  // the fronts are empty again.
+  for (const auto &front : solver._fronts) {
+    ASSERT_TRUE(front.empty());
   }
-  ASSERT_EQ(solver._constraints[1][1][0].time, 4);
-  ASSERT_EQ(solver._constraints[1][1][0].revenue, 1);
-  tuple<int, int> t1 {0, 0};
-  ASSERT_EQ(solver._constraints[1][1][0].predecessor, t1);
-  set<size_t> s1 = {1};
-  ASSERT_EQ(solver._constraints[1][1][0].prohibJobs, s1);
-  ASSERT_EQ(solver._constraints[1][2][0].time, 8);
-  ASSERT_EQ(solver._constraints[1][2][0].revenue, 1);
-  tuple<size_t, size_t> t {0, 0};
-  ASSERT_EQ(solver._constraints[1][2][0].predecessor, t);
-  set<size_t> s = {2};
-  ASSERT_EQ(solver._constraints[1][2][0].prohibJobs, s);
 }
 
 // _____________________________________________________________________________
-TEST(FptSolverTest, checkProhibited) {
+TEST(FptSolverTest, sharedInstance) {
   Graph g;
-  g.buildFromFile("test_data/example_graph2.graph", true);
-  FptSolver solver = FptSolver(g);
-  solver.initConstraints();
-  ASSERT_FALSE(solver.checkProhibited(1, 2, 5));
+  g.buildFromFile("test_data/example_graph4.graph", false);
+  FptSolver fromGraph = FptSolver(g);
+  auto expected = fromGraph.solve();
+
+  // solvers of one instance share its tables and still solve alone.
+  SharedInstance instance = std::make_shared<const Instance>(g);
+  FptOptions options;
+  options.pruneByBound = true;
+  FptSolver first = FptSolver(instance);
+  FptSolver second = FptSolver(instance, options);
+  ASSERT_EQ(first._graph, &instance->graph());
+  ASSERT_EQ(first._index, second._index);
+  ASSERT_EQ(first._prohibThresholds, second._prohibThresholds);
+  ASSERT_EQ(first.solve(), expected);
+  ASSERT_EQ(std::get<0>(second.solve()), std::get<0>(expected));
+  ASSERT_EQ(first.getTour(std::get<1>(expected)).size(), 3);
 }
 
 // _____________________________________________________________________________
@@ -47,7 +63,7 @@ TEST(FptSolverTest, solve) {
   FptSolver solver1 = FptSolver(g1);
   auto result = solver1.solve();
   ASSERT_EQ(std::get<0>(result), 1);
-  tuple<size_t, size_t, size_t> end {1, 1, 0};
+  tuple<size_t, size_t, size_t> end {1, 1, solver1._labels.cellBegin(1, 1)};
   ASSERT_EQ(std::get<1>(result), end);
 
   Graph g2;
@@ -55,7 +71,8 @@ TEST(FptSolverTest, solve) {
   FptSolver solver2 = FptSolver(g2);
   auto result2 = solver2.solve();
   ASSERT_EQ(std::get<0>(result2), 3);
-  tuple<size_t, size_t, size_t> end2 {3, 1, 0};
+  tuple<size_t, size_t, size_t> end2 {3, 1,
+                                     solver2._labels.cellBegin(3, 1)};
   ASSERT_EQ(std::get<1>(result2), end2);
 
   Graph g3;
@@ -63,7 +80,9 @@ TEST(FptSolverTest, solve) {
   FptSolver solver3 = FptSolver(g3);
   auto result3 = solver3.solve();
   ASSERT_EQ(std::get<0>(result3), 12);
-  tuple<size_t, size_t, size_t> end3 {3, 4, 1};
+  // the second label of node4 at level 3.
+  tuple<size_t, size_t, size_t> end3 {3, 4,
+                                     solver3._labels.cellBegin(3, 4) + 1};
   ASSERT_EQ(std::get<1>(result3), end3);
 
   Graph g4;
@@ -71,7 +90,8 @@ TEST(FptSolverTest, solve) {
   FptSolver solver4 = FptSolver(g4);
   auto result4 = solver4.solve();
   ASSERT_EQ(std::get<0>(result4), 3);
-  tuple<size_t, size_t, size_t> end4 {3, 4, 0};
+  tuple<size_t, size_t, size_t> end4 {3, 4,
+                                     solver4._labels.cellBegin(3, 4)};
   ASSERT_EQ(std::get<1>(result4), end4);
 }
 
@@ -81,43 +101,48 @@ TEST(FptSolverTest, updateConstraints) {
   g.buildFromFile("test_data/example_graph4.graph", true);
   FptSolver s = FptSolver(g);
   s.initConstraints();
-  tuple<size_t, size_t> pred {0, 0};
+  uint32_t pred = 0;
 
-  set<size_t> prohibJNew = {2};
-  set<size_t> prohibJ1 = {2, 3};
-  set<size_t> prohibJ2 = {1, 3};
+  JobSet prohibJNew = {2};
+  uint32_t prohibJ1 = s._prohibSets.intern({2, 3});
+  uint32_t prohibJ2 = s._prohibSets.intern({1, 3});
 
-  Constraint newCon = {4, 5, pred, prohibJNew};
+  // the new constraint gets its prohibited jobs interned once inserted.
+  Constraint newCon = {4, 5, pred, 0};
   Constraint constr1 = {5, 3, pred, prohibJ1};
   Constraint constr2 = {6, 3, pred, prohibJ2};
 
-  s._constraints[2][2].push_back(constr1);
-  s._constraints[2][2].push_back(constr2);
-  s.updateConstraints(newCon, 2, 2);
+  s._fronts[2].push_back(constr1);
+  s._fronts[2].push_back(constr2);
+  s.updateConstraints(newCon, prohibJNew, 2);
 
-  // constraint #2 will be deleted and the new constraint added.
-  ASSERT_EQ(s._constraints[2][2].size(), 2);
-  ASSERT_EQ(s._constraints[2][2][0].time, 6);
-  ASSERT_EQ(s._constraints[2][2][0].revenue, 3);
-  ASSERT_EQ(s._constraints[2][2][1].time, 4);
-  ASSERT_EQ(s._constraints[2][2][1].revenue, 5);
+  // constraint #1 will be deleted and the new constraint added
+  // in front of constraint #2, which starts later.
+  ASSERT_EQ(s._fronts[2].size(), 2);
+  ASSERT_EQ(s._fronts[2][0].time, 4);
+  ASSERT_EQ(s._fronts[2][0].revenue, 5);
+  ASSERT_EQ(s._fronts[2][1].time, 6);
+  ASSERT_EQ(s._fronts[2][1].revenue, 3);
+  // the first level already holds the set {2}, which is shared.
+  ASSERT_EQ(s._fronts[2][0].prohibJobs, s._prohibSets.intern({2}));
 
-  set<size_t> prohibJNew1 = {2};
-  set<size_t> prohibJ1_1 = {2, 3};
-  set<size_t> prohibJ2_1 = {2};
+  JobSet prohibJNew1 = {2};
+  uint32_t prohibJ1_1 = s._prohibSets.intern({2, 3});
+  uint32_t prohibJ2_1 = s._prohibSets.intern({2});
 
-  Constraint newCon1 = {4, 5, pred, prohibJNew1};
+  Constraint newCon1 = {4, 5, pred, 0};
   Constraint constr11 = {5, 3, pred, prohibJ1_1};
   Constraint constr21 = {3, 6, pred, prohibJ2_1};
 
-  s._constraints[2][3].push_back(constr11);
-  s._constraints[2][3].push_back(constr21);
-  s.updateConstraints(newCon, 2, 3);
+  // constraints of a cell are kept sorted by time.
+  s._fronts[3].push_back(constr21);
+  s._fronts[3].push_back(constr11);
+  s.updateConstraints(newCon, prohibJNew1, 3);
 
-  // new constraint not added and #2 deleted.
-  ASSERT_EQ(s._constraints[2][3].size(), 1);
-  ASSERT_EQ(s._constraints[2][3][0].time, 3);
-  ASSERT_EQ(s._constraints[2][3][0].revenue, 6);
+  // new constraint not added and #1 deleted.
+  ASSERT_EQ(s._fronts[3].size(), 1);
+  ASSERT_EQ(s._fronts[3][0].time, 3);
+  ASSERT_EQ(s._fronts[3][0].revenue, 6);
 }
 
 // _____________________________________________________________________________
@@ -148,3 +173,466 @@ TEST(FptSolverTest, getTour) {
   ASSERT_EQ(path[1].name, "node3");
   ASSERT_EQ(path[2].name, "node4");
 }
+
+// _____________________________________________________________________________
+TEST(FptSolverTest, labelArena) {
+  Graph g;
+  g.buildFromFile("test_data/example_graph4.graph", false);
+  FptSolver s = FptSolver(g);
+  auto result = s.solve();
+  ASSERT_EQ(std::get<0>(result), 12);
+  // the tour end is a label of the arena and its parents lead back to
+  // the start node through one label per level.
+  auto tourEnd = std::get<1>(result);
+  uint32_t label = std::get<2>(tourEnd);
+  ASSERT_EQ(s._labels.job(label), std::get<1>(tourEnd));
+  for (size_t level = std::get<0>(tourEnd); level > 0; level--) {
+    ASSERT_GE(label, s._labels.levelBegin(level));
+    ASSERT_LT(label, s._labels.levelEnd(level));
+    label = s._labels.parent(label);
+  }
+  ASSERT_EQ(label, 0);
+  // every cell is a front sorted by time and points to the level before.
+  for (size_t level = 1; level < s._labels.numLevels(); level++) {
+    for (size_t job = 0; job < g.getNodesNum(); job++) {
+      for (uint32_t l = s._labels.cellBegin(level, job);
+           l < s._labels.cellEnd(level, job); l++) {
+        ASSERT_EQ(s._labels.job(l), job);
+        ASSERT_LT(s._labels.parent(l), s._labels.levelBegin(level));
+        ASSERT_GE(s._labels.parent(l), s._labels.levelBegin(level - 1));
+        if (l > s._labels.cellBegin(level, job)) {
+          ASSERT_LE(s._labels.time(l - 1), s._labels.time(l));
+        }
+      }
+    }
+  }
+  auto path = s.getTour(tourEnd);
+  ASSERT_EQ(path.size(), 3);
+  ASSERT_EQ(path[0].id, 2);
+  ASSERT_EQ(path[1].id, 3);
+  ASSERT_EQ(path[2].id, 4);
+
+  // a second solve starts from an empty arena.
+  ASSERT_EQ(s.solve(), result);
+}
+
+// _____________________________________________________________________________
+TEST(FptSolverTest, rollingLevels) {
+  FptOptions options;
+  options.rollingLevels = true;
+  Graph g;
+  g.buildFromFile("test_data/example_graph4.graph", false);
+  FptSolver s = FptSolver(g, options);
+  auto result = s.solve();
+  ASSERT_EQ(std::get<0>(result), 12);
+  auto path = s.getTour(std::get<1>(result));
+  ASSERT_EQ(path.size(), 3);
+  ASSERT_EQ(path[0].id, 2);
+  ASSERT_EQ(path[1].id, 3);
+  ASSERT_EQ(path[2].id, 4);
+  ASSERT_EQ(path[0].arrival, 0);
+  ASSERT_EQ(path[1].arrival, 6);
+  ASSERT_EQ(path[2].arrival, 13);
+  // the pool only holds the sets of the first and the last level.
+  size_t last = s._labels.numLevels() - 1;
+  ASSERT_LE(s._prohibSets.size(), s._pinnedSets + s._labels.levelEnd(last)
+                                  - s._labels.levelBegin(last));
+
+  // the same prizes and tours as with all levels, also in the other
+  // modes.
+  vector<string> files = {"test_data/example_graph3.graph",
+                          "test_data/example_graph5.graph",
+                          "graph_data/10_random/10_random_00.graph",
+                          "graph_data/15_cluster/15_cluster_00.graph"};
+  for (const auto &file : files) {
+    Graph graph;
+    graph.buildFromFile(file, false);
+    for (size_t mode = 0; mode < 4; mode++) {
+      FptOptions full;
+      full.threads = mode == 1 ? 2 : 1;
+      full.bidirectional = mode == 2;
+      full.pruneByBound = mode == 3;
+      FptOptions rolling = full;
+      rolling.rollingLevels = true;
+      FptSolver expected = FptSolver(graph, full);
+      FptSolver actual = FptSolver(graph, rolling);
+      FptResult expectedResult = expected.solveWithin(60.0);
+      FptResult actualResult = actual.solveWithin(60.0);
+      ASSERT_EQ(actualResult.prize, expectedResult.prize) << file << mode;
+      ASSERT_EQ(actualResult.tour.size(), expectedResult.tour.size())
+          << file << mode;
+      for (size_t i = 0; i < actualResult.tour.size(); i++) {
+        ASSERT_EQ(actualResult.tour[i].id, expectedResult.tour[i].id);
+        ASSERT_EQ(actualResult.tour[i].arrival,
+                  expectedResult.tour[i].arrival);
+      }
+      ASSERT_LE(actual._prohibSets.size(), expected._prohibSets.size());
+    }
+  }
+}
+
+// _____________________________________________________________________________
+TEST(FptSolverTest, parallelSolve) {
+  Graph g;
+  g.buildFromFile("test_data/example_graph4.graph", false);
+  FptSolver sequential = FptSolver(g);
+  auto expected = sequential.solve();
+
+  for (size_t threads = 2; threads <= 4; threads++) {
+    FptOptions options;
+    options.threads = threads;
+    FptSolver s = FptSolver(g, options);
+    auto result = s.solve();
+    ASSERT_EQ(result, expected);
+    // the labels are identical to the sequential run.
+    const LabelArena &labels = s._labels;
+    const LabelArena &expectedLabels = sequential._labels;
+    ASSERT_EQ(labels.numLevels(), expectedLabels.numLevels());
+    ASSERT_EQ(labels.size(), expectedLabels.size());
+    for (uint32_t l = 0; l < labels.size(); l++) {
+      ASSERT_EQ(labels.job(l), expectedLabels.job(l));
+      ASSERT_EQ(labels.time(l), expectedLabels.time(l));
+      ASSERT_EQ(labels.revenue(l), expectedLabels.revenue(l));
+      ASSERT_EQ(labels.parent(l), expectedLabels.parent(l));
+      ASSERT_EQ(s._prohibSets.get(labels.prohibJobs(l)),
+                sequential._prohibSets.get(expectedLabels.prohibJobs(l)));
+    }
+    auto path = s.getTour(std::get<1>(result));
+    ASSERT_EQ(path.size(), 3);
+    ASSERT_EQ(path[1].id, 3);
+  }
+}
+
+// _____________________________________________________________________________
+TEST(FptSolverTest, pruneByBound) {
+  FptOptions options;
+  options.pruneByBound = true;
+  Graph g;
+  g.buildFromFile("test_data/example_graph4.graph", false);
+  FptSolver s = FptSolver(g, options);
+  s.initConstraints();
+  s.initBounds();
+  // the greedy tour 2 -> 3 -> 4 is already optimal.
+  ASSERT_EQ(s.greedyPrize(), 12);
+  ASSERT_EQ(s._incumbent, 12);
+  // from node 2 at time 0 all other jobs are still reachable.
+  ASSERT_EQ(s.bound(s._labels.cellBegin(1, 2)), 13);
+  // from node 3 at time 6 only node 4 is left.
+  ASSERT_EQ(s.bound(s._labels.cellBegin(1, 3)), 9);
+
+  FptSolver pruned = FptSolver(g, options);
+  auto result = pruned.solve();
+  ASSERT_EQ(std::get<0>(result), 12);
+  auto path = pruned.getTour(std::get<1>(result));
+  ASSERT_EQ(path.size(), 3);
+  ASSERT_EQ(path[0].id, 2);
+  ASSERT_EQ(path[1].id, 3);
+  ASSERT_EQ(path[2].id, 4);
+
+  Graph g1;
+  g1.buildFromFile("test_data/example_graph3.graph", true);
+  FptSolver pruned1 = FptSolver(g1, options);
+  ASSERT_EQ(std::get<0>(pruned1.solve()), 3);
+
+  // a job that can never be served does not count for the incumbent.
+  Graph g2;
+  g2.buildFromFile("test_data/example_graph6.graph", false);
+  FptSolver plain2 = FptSolver(g2);
+  FptSolver pruned2 = FptSolver(g2, options);
+  size_t prize2 = std::get<0>(plain2.solve());
+  ASSERT_EQ(prize2, 2);
+  ASSERT_EQ(std::get<0>(pruned2.solve()), prize2);
+  ASSERT_EQ(pruned2._incumbent, prize2);
+}
+
+// _____________________________________________________________________________
+TEST(FptSolverTest, solveWithin) {
+  Graph g;
+  g.buildFromFile("test_data/example_graph4.graph", false);
+  vector<size_t> improvements;
+  FptSolver s = FptSolver(g);
+  auto result = s.solveWithin(60.0, nullptr,
+      [&improvements](size_t prize, const vector<Location> &tour) {
+        size_t sum = 0;
+        for (const auto &loc : tour) {
+          sum += loc.prize;
+        }
+        ASSERT_EQ(sum, prize);
+        improvements.push_back(prize);
+      });
+  ASSERT_TRUE(result.optimal);
+  ASSERT_EQ(result.prize, 12);
+  ASSERT_EQ(result.tour.size(), 3);
+  ASSERT_EQ(result.tour[2].id, 4);
+  ASSERT_FALSE(s._stopped);
+  ASSERT_EQ(improvements.back(), 12);
+  for (size_t i = 1; i < improvements.size(); i++) {
+    ASSERT_LT(improvements[i - 1], improvements[i]);
+  }
+
+  // cancelled before the first expansion, only single jobs are known.
+  std::atomic<bool> cancel(true);
+  FptSolver cancelled = FptSolver(g);
+  auto partial = cancelled.solveWithin(60.0, &cancel);
+  ASSERT_FALSE(partial.optimal);
+  ASSERT_EQ(partial.prize, 6);
+  ASSERT_EQ(partial.tour.size(), 1);
+  ASSERT_EQ(partial.tour[0].id, 3);
+
+  // the same with an exhausted time budget.
+  FptSolver timedOut = FptSolver(g);
+  partial = timedOut.solveWithin(0.0);
+  ASSERT_FALSE(partial.optimal);
+  ASSERT_EQ(partial.prize, 6);
+  ASSERT_EQ(partial.tour[0].id, 3);
+
+  // only an expansion cut short stops the search, a level without
+  // labels is complete whatever the budget.
+  FptSolver expanded = FptSolver(g);
+  expanded.initConstraints();
+  expanded.closeFronts(&expanded._labels);
+  expanded._cancel = &cancel;
+  ASSERT_FALSE(expanded.expandLevel(2));
+  ASSERT_FALSE(expanded._stopped);
+  expanded.expandLevel(1);
+  ASSERT_TRUE(expanded._stopped);
+}
+
+// _____________________________________________________________________________
+TEST(FptSolverTest, stats) {
+  Graph g;
+  g.buildFromFile("test_data/example_graph4.graph", false);
+  FptSolver s = FptSolver(g);
+  FptStats stats = std::get<2>(s.solve());
+#if FPT_STATS
+  // every label of the cells was scanned once.
+  size_t labels = 0;
+  size_t widest = 0;
+  for (size_t level = 1; level < s._labels.numLevels(); level++) {
+    size_t levelLabels = s._labels.levelEnd(level)
+                         - s._labels.levelBegin(level);
+    for (size_t job = 0; job < g.getNodesNum(); job++) {
+      widest = std::max<size_t>(widest, s._labels.cellEnd(level, job)
+                                        - s._labels.cellBegin(level, job));
+    }
+    if (level < stats.levelLabels.size()) {
+      ASSERT_EQ(stats.levelLabels[level], levelLabels);
+      labels += levelLabels;
+    }
+  }
+  ASSERT_EQ(stats.labels, labels);
+  ASSERT_EQ(stats.widestFront, widest);
+  // the first level holds one label per job, each prohibiting itself.
+  ASSERT_EQ(stats.levelLabels[1], g.getNodesNum() - 1);
+  ASSERT_GE(stats.averageProhib(), 1.0);
+  // every continuation is either kept, dominated or later removed.
+  ASSERT_EQ(stats.generated - stats.dominatedOnInsert - stats.removedFromCell,
+            labels - stats.levelLabels[1]);
+  ASSERT_EQ(stats.pruned, 0);
+#else
+  ASSERT_EQ(stats, FptStats());
+#endif
+
+  // the counts do not depend on the number of threads.
+  FptOptions options;
+  options.threads = 3;
+  FptSolver parallel = FptSolver(g, options);
+  ASSERT_EQ(std::get<2>(parallel.solve()), stats);
+}
+
+// _____________________________________________________________________________
+TEST(FptSolverTest, bidirectional) {
+  Graph g;
+  g.buildFromFile("test_data/example_graph4.graph", false);
+  FptOptions options;
+  options.bidirectional = true;
+  FptSolver s = FptSolver(g, options);
+  auto result = s.solve();
+  ASSERT_EQ(std::get<0>(result), 12);
+  // the median of the window centres 1.5, 6, 7 and 8.5.
+  ASSERT_EQ(s._midpoint, 7);
+  // node2 is joined with the backward label of node3 and node4.
+  ASSERT_EQ(std::get<1>(result),
+            std::make_tuple(1, 2, s._labels.cellBegin(1, 2)));
+  ASSERT_EQ(std::get<0>(s._joinedStart), 2);
+  ASSERT_EQ(std::get<1>(s._joinedStart), 3);
+  auto path = s.getTour(std::get<1>(result));
+  ASSERT_EQ(path.size(), 3);
+  ASSERT_EQ(path[0].id, 2);
+  ASSERT_EQ(path[1].id, 3);
+  ASSERT_EQ(path[2].id, 4);
+  ASSERT_EQ(path[1].arrival, 6);
+  ASSERT_EQ(path[2].arrival, 13);
+  ASSERT_EQ(path[2].leave, 14);
+#if FPT_STATS
+  ASSERT_GT(std::get<2>(result).backwardLabels, 0);
+#endif
+
+  // the same prizes as the forward search.
+  vector<string> files = {"test_data/example_graph1.graph",
+                          "test_data/example_graph2.graph",
+                          "test_data/example_graph3.graph",
+                          "test_data/example_graph5.graph",
+                          "graph_data/10_random/10_random_00.graph",
+                          "graph_data/15_cluster/15_cluster_00.graph"};
+  for (const auto &file : files) {
+    Graph graph;
+    graph.buildFromFile(file, false);
+    FptSolver forward = FptSolver(graph);
+    size_t expected = std::get<0>(forward.solve());
+    FptSolver both = FptSolver(graph, options);
+    FptResult joined = both.solveWithin(60.0);
+    ASSERT_EQ(joined.prize, expected) << file;
+    size_t prize = 0;
+    for (const auto &loc : joined.tour) {
+      prize += loc.prize;
+      ASSERT_LE(loc.leave, graph.getDeadlines()->at(loc.id));
+    }
+    ASSERT_EQ(prize, expected) << file;
+  }
+}
+
+// _____________________________________________________________________________
+TEST(FptSolverTest, neighbourhoods) {
+  Graph g;
+  g.buildFromFile("test_data/example_graph4.graph", false);
+  FptOptions options;
+  options.ngSize = 1;
+  options.bidirectional = true;
+  FptSolver s = FptSolver(g, options);
+  ASSERT_FALSE(s._options.bidirectional);
+  s.initNeighbourhoods();
+  // node1 and node2 are closest to each other, node4 is closest to node1.
+  ASSERT_EQ(s._ngSets[1], JobSet({1, 2}));
+  ASSERT_EQ(s._ngSets[2], JobSet({2, 1}));
+  ASSERT_EQ(s._ngSets[4], JobSet({4, 1}));
+
+  // node4 is visited twice with node3 in between.
+  vector<Location> tour(4);
+  tour[0].id = 2;
+  tour[1].id = 4;
+  tour[2].id = 3;
+  tour[3].id = 4;
+  ASSERT_EQ(s._ngSets[3], JobSet({3, 1}));
+  ASSERT_TRUE(s.growNeighbourhoods(tour));
+  ASSERT_EQ(s._ngSets[3], JobSet({3, 1, 4}));
+  ASSERT_EQ(s._ngSets[2], JobSet({2, 1}));
+
+  // the relaxed searches end with the elementary optimum.
+  FptSolver relaxed = FptSolver(g, options);
+  auto result = relaxed.solve();
+  ASSERT_EQ(std::get<0>(result), 12);
+#if FPT_STATS
+  ASSERT_GE(std::get<2>(result).relaxedSolves, 1);
+#endif
+  auto path = relaxed.getTour(std::get<1>(result));
+  ASSERT_EQ(path.size(), 3);
+  ASSERT_EQ(path[0].id, 2);
+  ASSERT_EQ(path[1].id, 3);
+  ASSERT_EQ(path[2].id, 4);
+
+  // the same prizes as the elementary search.
+  options.ngSize = 2;
+  for (const string file : {"graph_data/10_random/10_random_00.graph",
+                            "graph_data/15_cluster/15_cluster_00.graph"}) {
+    Graph graph;
+    graph.buildFromFile(file, false);
+    FptSolver exact = FptSolver(graph);
+    FptSolver relaxed = FptSolver(graph, options);
+    ASSERT_EQ(std::get<0>(relaxed.solve()), std::get<0>(exact.solve()));
+  }
+}
+
+// _____________________________________________________________________________
+TEST(FptSolverTest, beam) {
+  Graph g;
+  g.buildFromFile("graph_data/10_random/10_random_00.graph", false);
+  FptSolver exact = FptSolver(g);
+  size_t optimum = std::get<0>(exact.solve());
+  ASSERT_EQ(exact.upperBound(), optimum);
+
+  FptOptions options;
+  options.beamWidth = 1;
+  FptSolver s = FptSolver(g, options);
+  auto result = s.solve();
+  // every cell keeps at most one label.
+  for (size_t level = 1; level < s._labels.numLevels(); level++) {
+    for (size_t job = 0; job < g.getNodesNum(); job++) {
+      ASSERT_LE(s._labels.cellEnd(level, job) - s._labels.cellBegin(level, job),
+                1);
+    }
+  }
+  size_t prize = std::get<0>(result);
+  ASSERT_LE(prize, optimum);
+  ASSERT_GE(s.upperBound(), optimum);
+  ASSERT_EQ(s.getTour(std::get<1>(result)).size() > 0, prize > 0);
+#if FPT_STATS
+  ASSERT_GT(std::get<2>(result).trimmed, 0);
+#endif
+
+  // the budgeted solve reports the gap, a wide beam is exact.
+  FptResult beamed = FptSolver(g, options).solveWithin(60.0);
+  ASSERT_EQ(beamed.prize, prize);
+  ASSERT_EQ(beamed.upperBound, s.upperBound());
+  // the dropped labels might lead to better tours.
+  ASSERT_GT(beamed.upperBound, prize);
+  ASSERT_FALSE(beamed.optimal);
+  options.beamWidth = 1000;
+  FptResult wide = FptSolver(g, options).solveWithin(60.0);
+  ASSERT_EQ(wide.prize, optimum);
+  ASSERT_EQ(wide.upperBound, optimum);
+  ASSERT_TRUE(wide.optimal);
+
+  // the time bound lies between the optimum and the bound by prizes.
+  for (size_t i = 0; i < 10; i++) {
+    Graph h;
+    h.buildFromFile("graph_data/10_random/10_random_0" + std::to_string(i)
+                    + ".graph", false);
+    FptSolver full = FptSolver(h);
+    size_t best = std::get<0>(full.solve());
+    options.beamWidth = 1;
+    FptSolver narrow = FptSolver(h, options);
+    narrow.solve();
+    ASSERT_GE(narrow.upperBound(), best);
+    ASSERT_GE(narrow.rootBound(), best);
+    for (size_t job = 1; job < h.getNodesNum(); job++) {
+      if (!narrow._index->servable(job)) {continue;}
+      double start = narrow._index->earliestStart(job);
+      size_t prize = (*h.getPrizes())[job];
+      ASSERT_LE(narrow.timeBound(start, prize, JobSet({job}), job),
+                narrow.bound(start, prize, JobSet({job}), job));
+    }
+  }
+}
+
+// _____________________________________________________________________________
+TEST(FptSolverTest, modesAgree) {
+  // every mode filters the jobs alike, also the unservable node1 of
+  // example_graph6, and finds the same optimum.
+  vector<string> files = {"test_data/example_graph3.graph",
+                          "test_data/example_graph4.graph",
+                          "test_data/example_graph5.graph",
+                          "test_data/example_graph6.graph",
+                          "graph_data/10_random/10_random_00.graph",
+                          "graph_data/15_cluster/15_cluster_00.graph"};
+  for (const auto &file : files) {
+    Graph graph;
+    graph.buildFromFile(file, false);
+    size_t expected = FptSolver(graph).solveWithin(60.0).prize;
+    for (size_t mode = 1; mode < 5; mode++) {
+      FptOptions options;
+      options.pruneByBound = mode == 1 || mode == 4;
+      options.beamWidth = mode == 2 ? 1000 : 0;
+      options.bidirectional = mode == 3 || mode == 4;
+      FptResult result = FptSolver(graph, options).solveWithin(60.0);
+      ASSERT_EQ(result.prize, expected) << file << mode;
+      ASSERT_TRUE(result.optimal) << file << mode;
+      size_t prize = 0;
+      for (const auto &loc : result.tour) {
+        prize += loc.prize;
+        ASSERT_LE(loc.leave, graph.getDeadlines()->at(loc.id));
+      }
+      ASSERT_EQ(prize, expected) << file << mode;
+    }
+  }
+}
@@ -2,13 +2,267 @@
 // Author: Felix Freyland <felix.freyland@gmx.de>
 
 #include "Graph.h"
-#include <boost/algorithm/string.hpp>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <string>
 #include <tuple>
 #include <vector>
 
+// Header of the binary graph format. Offsets are in bytes from the start
+// of the file, the distance matrix starts at a 64 byte boundary.
+struct BinaryGraphHeader {
+  char magic[8];
+  uint64_t version;
+  uint64_t numNodes;
+  uint64_t stride;  // doubles per row of the distance matrix.
+  uint64_t releases;
+  uint64_t deadlines;
+  uint64_t durations;
+  uint64_t prizes;
+  uint64_t locations;  // latitude and longitude per node.
+  uint64_t nameOffsets;  // numNodes + 1 offsets into the names.
+  uint64_t names;
+  uint64_t distances;
+  uint64_t fileSize;
+};
+
+static const char kBinaryMagic[8] = {'T', 'W', 'T', 'S', 'P', 'B', 'I', 'N'};
+static const uint64_t kBinaryVersion = 1;
+
+// ____________________________________________________________________________
+GraphParseError::GraphParseError(const string& fileName, const size_t line,
+                                 const string& message)
+    : std::runtime_error(fileName + ":"
+                         + (line > 0 ? std::to_string(line) + ":" : "") + " "
+                         + message) {
+  _line = line;
+}
+
+// ____________________________________________________________________________
+size_t GraphParseError::line() const {
+  return _line;
+}
+
+// A graph text file mapped into memory for the duration of parsing.
+class TextFile {
+ public:
+  explicit TextFile(const string& fileName) {
+    _data = nullptr;
+    _length = 0;
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw GraphParseError(fileName, 0, "cannot open file");
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+      close(fd);
+      throw GraphParseError(fileName, 0, "cannot read file status");
+    }
+    _length = status.st_size;
+    if (_length > 0) {
+      void* mapping = mmap(nullptr, _length, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping == MAP_FAILED) {
+        close(fd);
+        throw GraphParseError(fileName, 0, "cannot map file");
+      }
+      madvise(mapping, _length, MADV_SEQUENTIAL);
+      _data = static_cast<const char*>(mapping);
+    }
+    close(fd);
+  }
+  ~TextFile() {
+    if (_data != nullptr) {
+      munmap(const_cast<char*>(_data), _length);
+    }
+  }
+  const char* begin() const { return _data; }
+  const char* end() const { return _data + _length; }
+
+ private:
+  TextFile(const TextFile&) = delete;
+  TextFile& operator=(const TextFile&) = delete;
+  const char* _data;
+  size_t _length;
+};
+
+// Powers of ten that are exact doubles.
+static const double kExactPowers[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Scans a graph text file front to back. Numbers are parsed in place
+// without copying tokens, errors are reported with the current line.
+class TextScanner {
+ public:
+  TextScanner(const char* begin, const char* end, const string& fileName)
+      : _fileName(fileName) {
+    _pos = begin;
+    _end = end;
+    _line = 1;
+  }
+
+  bool atEnd() const { return _pos == _end; }
+  bool atLineEnd() const {
+    return _pos == _end || *_pos == '\n' || *_pos == '\r';
+  }
+  bool isComment() const { return _pos != _end && *_pos == '#'; }
+
+  // True for comment lines and lines of white space only.
+  bool isCommentOrBlank() const {
+    const char* p = _pos;
+    while (p != _end && (*p == ' ' || *p == '\t')) {
+      p++;
+    }
+    return p == _end || *p == '#' || *p == '\n' || *p == '\r';
+  }
+
+  void skipSpaces() {
+    while (_pos != _end && (*_pos == ' ' || *_pos == '\t')) {
+      _pos++;
+    }
+  }
+
+  // Moves to the start of the next line.
+  void nextLine() {
+    const char* newline = static_cast<const char*>(
+        memchr(_pos, '\n', _end - _pos));
+    _pos = newline == nullptr ? _end : newline + 1;
+    _line++;
+  }
+
+  // Like nextLine, but only trailing white space may be skipped.
+  void endLine() {
+    while (_pos != _end && (*_pos == ' ' || *_pos == '\t' || *_pos == '\r')) {
+      _pos++;
+    }
+    if (_pos != _end && *_pos != '\n') {
+      fail("unexpected '" + string(1, *_pos) + "' at end of line");
+    }
+    nextLine();
+  }
+
+  void expect(const char c) {
+    if (c != '\t') {
+      skipSpaces();
+    }
+    if (_pos == _end || *_pos != c) {
+      fail(c == '\t' ? string("expected tab") : "expected '" + string(1, c)
+                                                + "'");
+    }
+    _pos++;
+  }
+
+  // Returns the text up to the next tab and moves past the tab.
+  string field() {
+    const char* begin = _pos;
+    skipField();
+    return string(begin, _pos - 1);
+  }
+  void skipField() {
+    while (!atLineEnd() && *_pos != '\t') {
+      _pos++;
+    }
+    expect('\t');
+  }
+
+  size_t parseUnsigned(const char* what) {
+    skipSpaces();
+    if (_pos == _end || !isDigit(*_pos)) {
+      fail(string("expected ") + what);
+    }
+    size_t value = 0;
+    while (_pos != _end && isDigit(*_pos)) {
+      value = value * 10 + (*_pos++ - '0');
+    }
+    return value;
+  }
+
+  // Decimals with at most 15 significant digits and 22 fraction digits
+  // are converted exactly by one division, the rest falls back to
+  // strtod. Both give the correctly rounded value.
+  double parseDouble(const char* what) {
+    skipSpaces();
+    const char* begin = _pos;
+    const char* p = _pos;
+    bool negative = false;
+    if (p != _end && (*p == '-' || *p == '+')) {
+      negative = *p == '-';
+      p++;
+    }
+    uint64_t mantissa = 0;
+    size_t digits = 0;
+    size_t fractionDigits = 0;
+    bool fraction = false;
+    while (p != _end) {
+      if (isDigit(*p)) {
+        mantissa = mantissa * 10 + (*p - '0');
+        digits++;
+        fractionDigits += fraction;
+        if (digits > 15) {
+          break;
+        }
+      } else if (*p == '.' && !fraction) {
+        fraction = true;
+      } else {
+        break;
+      }
+      p++;
+    }
+    if (digits == 0) {
+      fail(string("expected ") + what);
+    }
+    if (digits <= 15 && fractionDigits <= 22
+        && (p == _end || (*p != 'e' && *p != 'E' && !isDigit(*p)))) {
+      _pos = p;
+      double value = mantissa / kExactPowers[fractionDigits];
+      return negative ? -value : value;
+    }
+    return parseLongDouble(begin, what);
+  }
+
+  [[noreturn]] void fail(const string& message) const {
+    throw GraphParseError(_fileName, _line, message);
+  }
+
+ private:
+  static bool isDigit(const char c) { return c >= '0' && c <= '9'; }
+
+  // strtod on a terminated copy of the token.
+  double parseLongDouble(const char* begin, const char* what) {
+    char token[64];
+    size_t length = 0;
+    while (begin + length != _end && length + 1 < sizeof(token)
+           && !isspace(begin[length]) && begin[length] != ','
+           && begin[length] != ')') {
+      token[length] = begin[length];
+      length++;
+    }
+    token[length] = '\0';
+    char* tokenEnd;
+    double value = strtod(token, &tokenEnd);
+    if (tokenEnd == token) {
+      fail(string("expected ") + what);
+    }
+    _pos = begin + (tokenEnd - token);
+    return value;
+  }
+
+  const char* _pos;
+  const char* _end;
+  size_t _line;
+  const string& _fileName;
+};
+
 // ____________________________________________________________________________
 Graph::Graph() {
   _numNodes = 0;
@@ -16,9 +270,10 @@ Graph::Graph() {
   _deadlines = {};
   _durations = {};
   _prizes = {};
-  _distances = {};
   _nodeNames = {};
   _geoLocations = {};
+  _distances = nullptr;
+  _stride = 0;
 }
 
 // ____________________________________________________________________________
@@ -42,8 +297,13 @@ vector<string> const * Graph::getNodeNames() const {
   return &_nodeNames;
 }
 
-vector<vector<double>> const * Graph::getDistances() const {
-  return &_distances;
+size_t Graph::distanceStride() const {
+  return _stride;
+}
+
+// ____________________________________________________________________________
+bool Graph::isSubInstance() const {
+  return !_matrixIds.empty();
 }
 
 vector<tuple<double, double>> const * Graph::getLocations() const {
@@ -55,89 +315,309 @@ vector<size_t> const * Graph::getDurations() const {
 }
 
 // ____________________________________________________________________________
-void Graph::buildFromFile(const string fileName, const bool unitPrizes) {
-  std::ifstream file(fileName.c_str());
-  if (!file.is_open()) {
-    std::cerr << "Error opening file: " << fileName << std::endl;
+void Graph::allocateDistances() {
+  const size_t alignment = 64;
+  const size_t perLine = alignment / sizeof(double);
+  _stride = (_numNodes + perLine - 1) / perLine * perLine;
+  void* buffer = nullptr;
+  size_t bytes = std::max<size_t>(_numNodes * _stride, 1) * sizeof(double);
+  if (posix_memalign(&buffer, alignment, bytes) != 0) {
+    std::cerr << "Error allocating distances for " << _numNodes
+              << " nodes" << std::endl;
     exit(1);
   }
+  std::memset(buffer, 0, bytes);
+  _distances = std::shared_ptr<double>(static_cast<double*>(buffer), free);
+  _matrixIds.clear();
+}
 
-  std::string line;
-  while (true) {
-    std::getline(file, line);
-    // if (file.eof()) break;
-
-    // Skip the header in graph file.
-    if (line.at(0) == '#') continue;
+// ____________________________________________________________________________
+void Graph::buildFromFile(const string fileName, const bool unitPrizes) {
+  TextFile file(fileName);
+  TextScanner in(file.begin(), file.end(), fileName);
 
-    // Get the number of nodes in Graph.
-    if (isdigit(line[0])) {
-      _numNodes = atoi(line.c_str());
-      break;
+  // Skip the header, the first other line holds the number of nodes.
+  while (in.isCommentOrBlank()) {
+    if (in.atEnd()) {
+      in.fail("missing number of nodes");
     }
+    in.nextLine();
   }
+  _numNodes = in.parseUnsigned("number of nodes");
+  in.endLine();
 
-  int currentLine = 0;
-  while (currentLine < _numNodes) {
-    // read the line and write to members of graph.
-    std::getline(file, line);
-    vector<string> tokens;
-    while (true) {
-      int pos = line.find("\t");
-      if (pos == string::npos) {
-        tokens.push_back(line);
-        break;
-      }
-      tokens.push_back(line.substr(0, pos));
-      line = line.substr(pos + 1);
-    }
-
-    // write tokens to Graph member variables.
-    _nodeNames.push_back(tokens[1]);
-    string geoLoc = tokens[2].substr(1, tokens[2].size() - 2);
-    int sep = geoLoc.find(",");
-    double lat = std::stof(geoLoc.substr(0, sep));
-    double lon = std::stof(geoLoc.substr(sep + 1, string::npos));
-    const tuple<double, double> geoL(lat, lon);
-    _geoLocations.push_back(geoL);
-    string release = tokens[3];
-    _releases.push_back(atoi(release.c_str()));
-    string deadline = tokens[4];
-    _deadlines.push_back(atoi(deadline.c_str()));
-    string duration = tokens[5];
-    _durations.push_back(atoi(duration.c_str()));
+  _nodeNames.clear();
+  _geoLocations.clear();
+  _releases.clear();
+  _deadlines.clear();
+  _durations.clear();
+  _prizes.clear();
+  _nodeNames.reserve(_numNodes);
+  _geoLocations.reserve(_numNodes);
+  _releases.reserve(_numNodes);
+  _deadlines.reserve(_numNodes);
+  _durations.reserve(_numNodes);
+  _prizes.reserve(_numNodes);
+
+  // One tab separated row per node: id, name, (lat, lon), release,
+  // deadline, duration and prize.
+  for (size_t node = 0; node < _numNodes; node++) {
+    if (in.atEnd()) {
+      in.fail("missing node rows");
+    }
+    in.skipField();
+    _nodeNames.push_back(in.field());
+    in.expect('(');
+    double lat = in.parseDouble("latitude");
+    in.expect(',');
+    double lon = in.parseDouble("longitude");
+    in.expect(')');
+    in.expect('\t');
+    _geoLocations.push_back(std::make_tuple(lat, lon));
+    _releases.push_back(in.parseUnsigned("release"));
+    in.expect('\t');
+    _deadlines.push_back(in.parseUnsigned("deadline"));
+    in.expect('\t');
+    _durations.push_back(in.parseUnsigned("duration"));
     // either set unit prizes or read prizes from file.
     if (unitPrizes) {
-      if (currentLine == 0) {
-        _prizes.push_back(0);
-      } else {
-        _prizes.push_back(1);
-        }
+      _prizes.push_back(node == 0 ? 0 : 1);
+      in.nextLine();
     } else {
-      string prize = tokens[6];
-      _prizes.push_back(atoi(prize.c_str()));
+      in.expect('\t');
+      _prizes.push_back(in.parseUnsigned("prize"));
+      in.endLine();
+    }
+  }
+
+  // Read the distance matrix, it ends with the file or a comment.
+  allocateDistances();
+  size_t row = 0;
+  while (!in.atEnd() && !in.isComment()) {
+    if (in.isCommentOrBlank()) {
+      in.nextLine();
+      continue;
+    }
+    if (row >= _numNodes) {
+      in.fail("too many distance rows");
+    }
+    double* rowData = _distances.get() + row * _stride;
+    for (size_t col = 0; col < _numNodes; col++) {
+      if (in.atLineEnd()) {
+        in.fail("expected " + std::to_string(_numNodes) + " distances");
       }
+      rowData[col] = in.parseDouble("distance");
+      in.skipSpaces();
+    }
+    in.endLine();
+    row++;
+  }
+  if (row < _numNodes) {
+    in.fail("expected " + std::to_string(_numNodes) + " distance rows");
+  }
+}
+
+// ____________________________________________________________________________
+void Graph::writeBinary(const string fileName) const {
+  BinaryGraphHeader header;
+  std::memcpy(header.magic, kBinaryMagic, sizeof(kBinaryMagic));
+  header.version = kBinaryVersion;
+  // sub-instances are written with a matrix of their own.
+  const size_t perLine = 64 / sizeof(double);
+  const size_t stride = isSubInstance()
+      ? (_numNodes + perLine - 1) / perLine * perLine : _stride;
+  header.numNodes = _numNodes;
+  header.stride = stride;
 
-    currentLine++;
+  // the string table of the node names.
+  vector<uint64_t> nameOffsets = {0};
+  string names;
+  for (const auto& name : _nodeNames) {
+    names += name;
+    nameOffsets.push_back(names.size());
   }
 
-  // Read the distance matrix.
-  while (true) {
-    std::getline(file, line);
-    if ((file.eof()) || line.at(0) == '#') break;
-    vector<double> row;
-    boost::trim_right(line);
-    while (true) {
-      int pos = line.find(" ");
-      if (pos == string::npos) {
-        row.push_back(atof(line.substr(0, pos).c_str()));
-        break;
+  // layout of the sections, all arrays are 8 byte aligned.
+  uint64_t offset = sizeof(BinaryGraphHeader);
+  uint64_t arrayBytes = _numNodes * sizeof(uint64_t);
+  header.releases = offset;
+  header.deadlines = header.releases + arrayBytes;
+  header.durations = header.deadlines + arrayBytes;
+  header.prizes = header.durations + arrayBytes;
+  header.locations = header.prizes + arrayBytes;
+  header.nameOffsets = header.locations + 2 * _numNodes * sizeof(double);
+  header.names = header.nameOffsets + nameOffsets.size() * sizeof(uint64_t);
+  header.distances = (header.names + names.size() + 63) / 64 * 64;
+  header.fileSize = header.distances + _numNodes * stride * sizeof(double);
+
+  std::ofstream file(fileName.c_str(), std::ios::binary);
+  if (!file.is_open()) {
+    std::cerr << "Error opening file: " << fileName << std::endl;
+    exit(1);
+  }
+  auto writeArray = [&file](const vector<size_t>& values) {
+    for (auto value : values) {
+      uint64_t stored = value;
+      file.write(reinterpret_cast<const char*>(&stored), sizeof(stored));
+    }
+  };
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  writeArray(_releases);
+  writeArray(_deadlines);
+  writeArray(_durations);
+  writeArray(_prizes);
+  for (const auto& location : _geoLocations) {
+    double latLon[2] = {std::get<0>(location), std::get<1>(location)};
+    file.write(reinterpret_cast<const char*>(latLon), sizeof(latLon));
+  }
+  file.write(reinterpret_cast<const char*>(nameOffsets.data()),
+             nameOffsets.size() * sizeof(uint64_t));
+  file.write(names.data(), names.size());
+  string padding(header.distances - header.names - names.size(), '\0');
+  file.write(padding.data(), padding.size());
+  if (isSubInstance()) {
+    vector<double> row(stride, 0.0);
+    for (size_t from = 0; from < _numNodes; from++) {
+      for (size_t to = 0; to < _numNodes; to++) {
+        row[to] = distance(from, to);
       }
-      row.push_back(atof(line.substr(0, pos).c_str()));
-      line = line.substr(pos + 1);
+      file.write(reinterpret_cast<const char*>(row.data()),
+                 stride * sizeof(double));
     }
-    _distances.push_back(row);
+  } else {
+    file.write(reinterpret_cast<const char*>(_distances.get()),
+               _numNodes * _stride * sizeof(double));
+  }
+  if (!file.good()) {
+    std::cerr << "Error writing file: " << fileName << std::endl;
+    exit(1);
+  }
+}
+
+// Checks a binary graph file of length bytes mapped at base. Every
+// section has to lie inside the file and the name offsets have to be
+// increasing. The sizes are compared without overflowing. Returns the
+// problem found or an empty string.
+static string checkBinaryGraph(const char* base, const uint64_t length) {
+  const BinaryGraphHeader* header
+      = reinterpret_cast<const BinaryGraphHeader*>(base);
+  if (std::memcmp(header->magic, kBinaryMagic, sizeof(kBinaryMagic)) != 0) {
+    return "not a binary graph file";
+  }
+  if (header->version != kBinaryVersion) {
+    return "unsupported version " + std::to_string(header->version);
+  }
+  if (header->fileSize != length) {
+    return "file size does not match the header";
+  }
+  // whether count items of size bytes fit between offset and the end,
+  // arrays of numbers also have to be aligned.
+  auto fits = [length](uint64_t offset, uint64_t count, uint64_t size) {
+    return offset <= length && offset % sizeof(uint64_t) == 0
+           && count <= (length - offset) / size;
+  };
+  const uint64_t numNodes = header->numNodes;
+  if (numNodes >= length) {
+    return "too many nodes for the file size";
   }
+  if (!fits(header->releases, numNodes, sizeof(uint64_t))
+      || !fits(header->deadlines, numNodes, sizeof(uint64_t))
+      || !fits(header->durations, numNodes, sizeof(uint64_t))
+      || !fits(header->prizes, numNodes, sizeof(uint64_t))
+      || !fits(header->locations, numNodes, 2 * sizeof(double))
+      || !fits(header->nameOffsets, numNodes + 1, sizeof(uint64_t))) {
+    return "node data out of range";
+  }
+  if (header->stride < numNodes || header->stride > length / sizeof(double)
+      || header->distances % 64 != 0
+      || (numNodes > 0 && !fits(header->distances, numNodes,
+                                header->stride * sizeof(double)))) {
+    return "distance matrix out of range";
+  }
+  if (header->names > length) {
+    return "names out of range";
+  }
+  const uint64_t* nameOffsets = reinterpret_cast<const uint64_t*>(
+      base + header->nameOffsets);
+  for (size_t node = 0; node < numNodes; node++) {
+    if (nameOffsets[node] > nameOffsets[node + 1]) {
+      return "name offsets are not increasing";
+    }
+  }
+  if (nameOffsets[numNodes] > length - header->names) {
+    return "names out of range";
+  }
+  return "";
+}
+
+// ____________________________________________________________________________
+void Graph::buildFromBinary(const string fileName, const bool unitPrizes) {
+  int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw GraphParseError(fileName, 0, "cannot open file");
+  }
+  struct stat status;
+  if (fstat(fd, &status) != 0) {
+    close(fd);
+    throw GraphParseError(fileName, 0, "cannot read file status");
+  }
+  size_t length = status.st_size;
+  if (length < sizeof(BinaryGraphHeader)) {
+    close(fd);
+    throw GraphParseError(fileName, 0, "not a binary graph file");
+  }
+  void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    throw GraphParseError(fileName, 0, "cannot map file");
+  }
+  const char* base = static_cast<const char*>(mapping);
+  string problem = checkBinaryGraph(base, length);
+  if (!problem.empty()) {
+    munmap(mapping, length);
+    throw GraphParseError(fileName, 0, problem);
+  }
+  const BinaryGraphHeader* header
+      = reinterpret_cast<const BinaryGraphHeader*>(base);
+
+  // copy the per-node arrays.
+  _numNodes = header->numNodes;
+  auto readArray = [base, this](uint64_t offset, vector<size_t>* values) {
+    const uint64_t* stored = reinterpret_cast<const uint64_t*>(base + offset);
+    values->assign(stored, stored + _numNodes);
+  };
+  readArray(header->releases, &_releases);
+  readArray(header->deadlines, &_deadlines);
+  readArray(header->durations, &_durations);
+  readArray(header->prizes, &_prizes);
+  if (unitPrizes) {
+    for (size_t node = 0; node < _numNodes; node++) {
+      _prizes[node] = node == 0 ? 0 : 1;
+    }
+  }
+  const double* latLon = reinterpret_cast<const double*>(base
+                                                         + header->locations);
+  const uint64_t* nameOffsets = reinterpret_cast<const uint64_t*>(
+      base + header->nameOffsets);
+  const char* names = base + header->names;
+  _geoLocations.clear();
+  _nodeNames.clear();
+  for (size_t node = 0; node < _numNodes; node++) {
+    _geoLocations.push_back(std::make_tuple(latLon[2 * node],
+                                            latLon[2 * node + 1]));
+    _nodeNames.push_back(string(names + nameOffsets[node],
+                                names + nameOffsets[node + 1]));
+  }
+
+  // the distance matrix stays in the mapping, which is released with
+  // the last graph sharing it.
+  _stride = header->stride;
+  _matrixIds.clear();
+  double* distances = reinterpret_cast<double*>(
+      const_cast<char*>(base) + header->distances);
+  _distances = std::shared_ptr<double>(distances, [mapping, length](double*) {
+    munmap(mapping, length);
+  });
 }
 
 // ____________________________________________________________________________
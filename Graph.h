@@ -5,6 +5,10 @@
 #define GRAPH_H_
 
 #include <gtest/gtest.h>
+#include <stdint.h>
+#include <cassert>
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <tuple>
@@ -24,6 +28,17 @@ struct Location {
   string name;
 };
 
+// Error in a graph text file. The message names the file and the line,
+// line 0 stands for errors concerning the whole file.
+class GraphParseError : public std::runtime_error {
+ public:
+  GraphParseError(const string& fileName, size_t line, const string& message);
+  size_t line() const;
+
+ private:
+  size_t _line;
+};
+
 // A class for a graph TW_TSP instance.
 class Graph {
  public:
@@ -36,13 +51,66 @@ class Graph {
   const vector<size_t>* getReleases() const;
   const vector<size_t>* getPrizes() const;
   const vector<string>* getNodeNames() const;
-  const vector<vector<double>>* getDistances() const;
   const vector<tuple<double, double>>* getLocations() const;
   const vector<size_t>* getDurations() const;
 
-  // To read the graph from a text file.
+  // Unchecked access to the distance matrix. The matrix is stored
+  // row-major in one buffer, every row starts at a 64 byte boundary.
+  // Sub-instances built by a GraphView map their node ids into the
+  // matrix of the full graph. Loops over many distances from one node
+  // use matrixRow and matrixColumns instead.
+  double distance(size_t from, size_t to) const {
+    if (!_matrixIds.empty()) {
+      from = _matrixIds[from];
+      to = _matrixIds[to];
+    }
+    return _distances.get()[from * _stride + to];
+  }
+  // Row of the matrix, only for graphs that are not sub-instances.
+  const double* distanceRow(size_t from) const {
+    assert(_matrixIds.empty() && "distanceRow of a sub-instance");
+    return _distances.get() + from * _stride;
+  }
+  size_t distanceStride() const;
+
+  // The matrix row of from and the matrix column of every node, which
+  // is nullptr unless the graph is a sub-instance. distance(from, to) is
+  // then row[to], or row[columns[to]] for sub-instances, so the mapping
+  // of from is only resolved once per row.
+  const double* matrixRow(size_t from) const {
+    if (!_matrixIds.empty()) {
+      from = _matrixIds[from];
+    }
+    return _distances.get() + from * _stride;
+  }
+  const uint32_t* matrixColumns() const {
+    return _matrixIds.empty() ? nullptr : _matrixIds.data();
+  }
+
+  // True if the graph is a sub-instance sharing the matrix of a larger
+  // graph.
+  bool isSubInstance() const;
+
+  // To read the graph from a text file. The file is scanned once and
+  // malformed input throws a GraphParseError with the line number.
   void buildFromFile(string fileName, bool unitPrizes = false);
   FRIEND_TEST(GraphTest, buildFromFile);
+  FRIEND_TEST(GraphTest, parseErrors);
+  FRIEND_TEST(GraphTest, distanceRow);
+
+  // To read the graph from a file in the binary format written by
+  // writeBinary. The file is memory mapped and the distance matrix is
+  // used in place, only the per-node arrays are copied. Files that are
+  // not complete binary graphs throw a GraphParseError.
+  void buildFromBinary(string fileName, bool unitPrizes = false);
+
+  // To write the graph in the binary format. It consists of a header,
+  // the per-node arrays, a string table with the node names and the
+  // distance matrix with the row stride of the graph. Numbers are
+  // stored in the byte order of the host.
+  void writeBinary(string fileName) const;
+  FRIEND_TEST(GraphTest, binaryFormat);
+  FRIEND_TEST(GraphTest, binaryErrors);
 
   // Destructor
   ~Graph();
@@ -53,9 +121,22 @@ class Graph {
   vector<size_t> _deadlines;
   vector<size_t> _durations;
   vector<size_t> _prizes;
-  vector<vector<double>> _distances;
   vector<string> _nodeNames;
   vector<tuple<double, double>> _geoLocations;
+
+  // Distance matrix with _stride doubles per row. Copies of the graph
+  // share the buffer.
+  std::shared_ptr<double> _distances;
+  size_t _stride;
+
+  // Row and column of each node in _distances, empty if they coincide
+  // with the node ids.
+  vector<uint32_t> _matrixIds;
+  friend class GraphView;
+  FRIEND_TEST(GraphViewTest, induce);
+
+  // Allocates a zeroed, aligned distance matrix for _numNodes nodes.
+  void allocateDistances();
 };
 
 #endif  // GRAPH_H_
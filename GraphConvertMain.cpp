@@ -0,0 +1,29 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#include <string>
+#include "Graph.h"
+
+using std::string;
+
+// Takes a .graph text file and writes the same graph in the binary
+// format, which Graph::buildFromBinary maps without parsing.
+int main(int argc, char *argv[]) {
+  if (argc != 3) {
+    fprintf(stderr, "Usage: ./GraphConvertMain <graph_file> <binary_file>\n");
+    fprintf(stderr, "Binary files should end with .bgraph to be read by "
+                    "TwTspMain\n");
+    exit(1);
+  }
+  string inFile = argv[1];
+  string outFile = argv[2];
+  Graph g;
+  try {
+    g.buildFromFile(inFile);
+  } catch (const GraphParseError& error) {
+    fprintf(stderr, "%s\n", error.what());
+    exit(1);
+  }
+  g.writeBinary(outFile);
+  return 0;
+}
@@ -2,6 +2,11 @@
 // Author: Felix Freyland <felix.freyland@gmx.de>
 
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
 #include "Graph.h"
 
 
@@ -49,20 +54,16 @@ TEST(GraphTest, buildFromFile) {
   ASSERT_EQ(g._durations[2], 2);
 
   // testing distance matrix.
-  ASSERT_EQ(g._distances.size(), 3);
-
-  for (int i = 0; i < 3; i++) {
-    ASSERT_EQ(g._distances[i].size(), 3);
-  }
-  ASSERT_EQ(g._distances[0][0], 0.0);
-  ASSERT_EQ(g._distances[0][1], 5.0);
-  ASSERT_EQ(g._distances[0][2], 10.0);
-  ASSERT_EQ(g._distances[1][0], 5.0);
-  ASSERT_EQ(g._distances[1][1], 0.0);
-  ASSERT_EQ(g._distances[1][2], 8.0);
-  ASSERT_EQ(g._distances[2][0], 10.0);
-  ASSERT_EQ(g._distances[2][1], 8.0);
-  ASSERT_EQ(g._distances[2][2], 0.0);
+  ASSERT_EQ(g._stride, 8);
+  ASSERT_EQ(g.distance(0, 0), 0.0);
+  ASSERT_EQ(g.distance(0, 1), 5.0);
+  ASSERT_EQ(g.distance(0, 2), 10.0);
+  ASSERT_EQ(g.distance(1, 0), 5.0);
+  ASSERT_EQ(g.distance(1, 1), 0.0);
+  ASSERT_EQ(g.distance(1, 2), 8.0);
+  ASSERT_EQ(g.distance(2, 0), 10.0);
+  ASSERT_EQ(g.distance(2, 1), 8.0);
+  ASSERT_EQ(g.distance(2, 2), 0.0);
 
   Graph g1;
   g1.buildFromFile("test_data/example_graph3.graph", false);
@@ -113,25 +114,201 @@ TEST(GraphTest, buildFromFile) {
   ASSERT_EQ(g1._durations[3], 15);
 
   // testing distance matrix.
-  ASSERT_EQ(g1._distances.size(), 4);
+  ASSERT_EQ(g1._stride, 8);
+  ASSERT_FLOAT_EQ(g1.distance(0, 0), 0.0);
+  ASSERT_FLOAT_EQ(g1.distance(0, 1), 0.0);
+  ASSERT_FLOAT_EQ(g1.distance(0, 2), 0.0);
+  ASSERT_FLOAT_EQ(g1.distance(0, 3), 0.0);
+  ASSERT_FLOAT_EQ(g1.distance(1, 0), 0.0);
+  ASSERT_FLOAT_EQ(g1.distance(1, 1), 0.0);
+  ASSERT_FLOAT_EQ(g1.distance(1, 2), 3.98);
+  ASSERT_FLOAT_EQ(g1.distance(1, 3), 3.02);
+  ASSERT_FLOAT_EQ(g1.distance(2, 0), 0.0);
+  ASSERT_FLOAT_EQ(g1.distance(2, 1), 4.09);
+  ASSERT_FLOAT_EQ(g1.distance(2, 2), 0.0);
+  ASSERT_FLOAT_EQ(g1.distance(2, 3), 1.01);
+  ASSERT_FLOAT_EQ(g1.distance(3, 0), 0.0);
+  ASSERT_FLOAT_EQ(g1.distance(3, 1), 3.09);
+  ASSERT_FLOAT_EQ(g1.distance(3, 2), 0.96);
+  ASSERT_FLOAT_EQ(g1.distance(3, 3), 0.0);
+}
+
+// _____________________________________________________________________________
+TEST(GraphTest, distanceRow) {
+  Graph g;
+  g.buildFromFile("test_data/example_graph4.graph", false);
+  ASSERT_EQ(g.distanceStride(), 8);
+  for (size_t row = 0; row < g.getNodesNum(); row++) {
+    const double* rowData = g.distanceRow(row);
+    // rows start at cache line boundaries.
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(rowData) % 64, 0);
+    for (size_t col = 0; col < g.getNodesNum(); col++) {
+      ASSERT_EQ(rowData[col], g.distance(row, col));
+    }
+  }
+  ASSERT_EQ(g.distance(1, 3), 5.0);
+  ASSERT_EQ(g.distance(4, 2), 7.0);
+
+  // copies share the distance buffer.
+  Graph copy = g;
+  ASSERT_EQ(copy.distanceRow(0), g.distanceRow(0));
+
+  // without a node id map the matrix rows are the distance rows.
+  ASSERT_EQ(g.matrixColumns(), nullptr);
+  ASSERT_EQ(g.matrixRow(3), g.distanceRow(3));
+}
 
-  for (int i = 0; i < 4; i++) {
-    ASSERT_EQ(g1._distances[i].size(), 4);
+// Writes text to a file, expects buildFromFile to fail at the given line
+// and removes the file again.
+void expectParseError(const string& text, size_t line) {
+  const string fileName = "GraphTest.parseErrors.graph";
+  std::ofstream(fileName) << text;
+  Graph g;
+  try {
+    g.buildFromFile(fileName);
+    ADD_FAILURE() << "no error for:\n" << text;
+  } catch (const GraphParseError& error) {
+    ASSERT_EQ(error.line(), line) << error.what();
+  }
+  std::remove(fileName.c_str());
+}
+
+// _____________________________________________________________________________
+TEST(GraphTest, parseErrors) {
+  const string header = "# comment\n2\n";
+  const string nodes = "0\tstart\t(0.0, 0.0)\t0\t0\t0\t0\n"
+                       "1\tnode\t(-35.25, 149.5)\t4\t6\t2\t3\n";
+  const string matrix = "0.0 1.5 \n1.5 0.0 \n";
+
+  // the well formed file parses with exact coordinates.
+  const string fileName = "GraphTest.parseErrors.graph";
+  std::ofstream(fileName) << header << nodes << matrix << "# trailer\n";
+  Graph g;
+  g.buildFromFile(fileName);
+  std::remove(fileName.c_str());
+  ASSERT_EQ(g._numNodes, 2);
+  ASSERT_EQ(g._nodeNames[1], "node");
+  ASSERT_EQ(std::get<0>(g._geoLocations[1]), -35.25);
+  ASSERT_EQ(std::get<1>(g._geoLocations[1]), 149.5);
+  ASSERT_EQ(g._prizes[1], 3);
+  ASSERT_EQ(g.distance(1, 0), 1.5);
+
+  expectParseError("# only a comment\n", 2);
+  expectParseError(header + "0\tstart\t0.0, 0.0)\t0\t0\t0\t0\n", 3);
+  expectParseError(header + nodes.substr(0, 20) + "\n", 3);
+  expectParseError(header + "0\tstart\t(0.0, 0.0)\t0\tx\t0\t0\n", 3);
+  expectParseError(header + nodes + "0.0 1.5\n1.5\n", 6);
+  expectParseError(header + nodes + "0.0 1.5 2.0\n", 5);
+  expectParseError(header + nodes + "0.0 1.5\n", 6);
+  expectParseError(header + nodes + matrix + "1.0 1.0\n", 7);
+
+  // a missing file has no line.
+  try {
+    g.buildFromFile("test_data/missing.graph");
+    ADD_FAILURE() << "no error for a missing file";
+  } catch (const GraphParseError& error) {
+    ASSERT_EQ(error.line(), 0);
   }
-  ASSERT_FLOAT_EQ(g1._distances[0][0], 0.0);
-  ASSERT_FLOAT_EQ(g1._distances[0][1], 0.0);
-  ASSERT_FLOAT_EQ(g1._distances[0][2], 0.0);
-  ASSERT_FLOAT_EQ(g1._distances[0][3], 0.0);
-  ASSERT_FLOAT_EQ(g1._distances[1][0], 0.0);
-  ASSERT_FLOAT_EQ(g1._distances[1][1], 0.0);
-  ASSERT_FLOAT_EQ(g1._distances[1][2], 3.98);
-  ASSERT_FLOAT_EQ(g1._distances[1][3], 3.02);
-  ASSERT_FLOAT_EQ(g1._distances[2][0], 0.0);
-  ASSERT_FLOAT_EQ(g1._distances[2][1], 4.09);
-  ASSERT_FLOAT_EQ(g1._distances[2][2], 0.0);
-  ASSERT_FLOAT_EQ(g1._distances[2][3], 1.01);
-  ASSERT_FLOAT_EQ(g1._distances[3][0], 0.0);
-  ASSERT_FLOAT_EQ(g1._distances[3][1], 3.09);
-  ASSERT_FLOAT_EQ(g1._distances[3][2], 0.96);
-  ASSERT_FLOAT_EQ(g1._distances[3][3], 0.0);
+}
+
+// _____________________________________________________________________________
+TEST(GraphTest, binaryFormat) {
+  Graph g;
+  g.buildFromFile("test_data/example_graph3.graph", false);
+  g.writeBinary("GraphTest.binaryFormat.bgraph");
+  Graph b;
+  b.buildFromBinary("GraphTest.binaryFormat.bgraph", false);
+  Graph u;
+  u.buildFromBinary("GraphTest.binaryFormat.bgraph", true);
+  std::remove("GraphTest.binaryFormat.bgraph");
+
+  ASSERT_EQ(b._numNodes, g._numNodes);
+  ASSERT_EQ(b._nodeNames, g._nodeNames);
+  ASSERT_EQ(b._geoLocations, g._geoLocations);
+  ASSERT_EQ(b._releases, g._releases);
+  ASSERT_EQ(b._deadlines, g._deadlines);
+  ASSERT_EQ(b._durations, g._durations);
+  ASSERT_EQ(b._prizes, g._prizes);
+  ASSERT_EQ(b._stride, g._stride);
+  for (size_t row = 0; row < g.getNodesNum(); row++) {
+    // the mapped rows keep the cache line alignment.
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(b.distanceRow(row)) % 64, 0);
+    for (size_t col = 0; col < g.getNodesNum(); col++) {
+      ASSERT_EQ(b.distance(row, col), g.distance(row, col));
+    }
+  }
+
+  // unit prizes are applied after loading.
+  ASSERT_EQ(u._prizes[0], 0);
+  for (size_t node = 1; node < u.getNodesNum(); node++) {
+    ASSERT_EQ(u._prizes[node], 1);
+  }
+}
+
+// Writes a binary graph file with the 64-bit word at offset replaced by
+// value, or cut to offset bytes if cut is set, and expects
+// buildFromBinary to reject it.
+void expectBinaryError(const string& data, size_t offset, uint64_t value,
+                       bool cut = false) {
+  string corrupt = cut ? data.substr(0, offset) : data;
+  if (!cut) {
+    std::memcpy(&corrupt[offset], &value, sizeof(value));
+  }
+  const string fileName = "GraphTest.binaryErrors.bgraph";
+  std::ofstream(fileName, std::ios::binary) << corrupt;
+  Graph g;
+  try {
+    g.buildFromBinary(fileName);
+    ADD_FAILURE() << "no error for offset " << offset << " value " << value;
+  } catch (const GraphParseError& error) {
+    ASSERT_EQ(error.line(), 0) << error.what();
+  }
+  std::remove(fileName.c_str());
+}
+
+// _____________________________________________________________________________
+TEST(GraphTest, binaryErrors) {
+  Graph g;
+  g.buildFromFile("test_data/example_graph3.graph", false);
+  g.writeBinary("GraphTest.binaryErrors.bgraph");
+  std::ifstream file("GraphTest.binaryErrors.bgraph", std::ios::binary);
+  string data((std::istreambuf_iterator<char>(file)),
+              std::istreambuf_iterator<char>());
+  file.close();
+  // the header words after the magic: version, numNodes, stride, the
+  // section offsets and the file size.
+  auto word = [&data](size_t index) {
+    uint64_t value;
+    std::memcpy(&value, &data[8 * index], sizeof(value));
+    return value;
+  };
+  const uint64_t huge = static_cast<uint64_t>(1) << 62;
+
+  expectBinaryError(data, 0, 0);
+  expectBinaryError(data, 8, 2);
+  expectBinaryError(data, data.size() - 8, 0, true);
+  expectBinaryError(data, 50, 0, true);
+  // too many nodes, also where the section sizes would overflow.
+  expectBinaryError(data, 16, word(2) + 1);
+  expectBinaryError(data, 16, huge);
+  // strides that are too small or overflow the matrix size.
+  expectBinaryError(data, 24, word(2) - 1);
+  expectBinaryError(data, 24, huge);
+  // sections beyond the end or misaligned.
+  for (size_t index = 4; index <= 9; index++) {
+    expectBinaryError(data, 8 * index, word(12));
+    expectBinaryError(data, 8 * index, word(index) + 1);
+  }
+  expectBinaryError(data, 80, word(12) + 1);
+  expectBinaryError(data, 88, word(11) + 64);
+  // name offsets that decrease or leave the names.
+  expectBinaryError(data, word(9) + 8, huge);
+  expectBinaryError(data, word(9) + 8 * word(2), word(12));
+
+  // the unchanged data still loads.
+  std::ofstream("GraphTest.binaryErrors.bgraph", std::ios::binary) << data;
+  Graph b;
+  b.buildFromBinary("GraphTest.binaryErrors.bgraph");
+  std::remove("GraphTest.binaryErrors.bgraph");
+  ASSERT_EQ(b._nodeNames, g._nodeNames);
 }
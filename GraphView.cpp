@@ -0,0 +1,55 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#include "GraphView.h"
+#include <stdint.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ____________________________________________________________________________
+GraphView::GraphView(const Graph& full) {
+  _full = full;
+}
+
+// ____________________________________________________________________________
+size_t GraphView::getNodesNum() const {
+  return _full.getNodesNum();
+}
+
+// ____________________________________________________________________________
+Graph GraphView::induce(const vector<size_t>& nodes,
+                        const bool unitPrizes) const {
+  Graph sub;
+  sub._numNodes = nodes.size();
+  sub._releases.reserve(nodes.size());
+  sub._deadlines.reserve(nodes.size());
+  sub._durations.reserve(nodes.size());
+  sub._prizes.reserve(nodes.size());
+  sub._nodeNames.reserve(nodes.size());
+  sub._geoLocations.reserve(nodes.size());
+  sub._matrixIds.reserve(nodes.size());
+  for (size_t i = 0; i < nodes.size(); i++) {
+    size_t node = nodes[i];
+    if (node >= _full._numNodes) {
+      throw std::out_of_range("node " + std::to_string(node)
+                              + " is not in the graph");
+    }
+    sub._releases.push_back(_full._releases[node]);
+    sub._deadlines.push_back(_full._deadlines[node]);
+    sub._durations.push_back(_full._durations[node]);
+    if (unitPrizes) {
+      sub._prizes.push_back(i == 0 ? 0 : 1);
+    } else {
+      sub._prizes.push_back(_full._prizes[node]);
+    }
+    sub._nodeNames.push_back(_full._nodeNames[node]);
+    sub._geoLocations.push_back(_full._geoLocations[node]);
+    // the full graph may itself be a sub-instance.
+    sub._matrixIds.push_back(_full.isSubInstance() ? _full._matrixIds[node]
+                                                   : node);
+  }
+  sub._distances = _full._distances;
+  sub._stride = _full._stride;
+  return sub;
+}
@@ -0,0 +1,35 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#ifndef GRAPHVIEW_H_
+#define GRAPHVIEW_H_
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "./Graph.h"
+
+using std::vector;
+
+// Builds induced sub-instances of one full graph. A sub-instance is a
+// Graph with its own per-node data, but its distances are looked up in
+// the matrix of the full graph through a node id map, so no matrix is
+// copied. Both solvers take the sub-instances like any other graph.
+class GraphView {
+ public:
+  // Constructor, the view shares the matrix of full.
+  explicit GraphView(const Graph& full);
+
+  // Number of nodes of the full graph.
+  size_t getNodesNum() const;
+
+  // The sub-instance on the given node ids of the full graph. Node i of
+  // the sub-instance is nodes[i], so nodes[0] is the starting point. Ids
+  // out of range throw std::out_of_range.
+  Graph induce(const vector<size_t>& nodes, bool unitPrizes = false) const;
+
+ private:
+  Graph _full;
+  FRIEND_TEST(GraphViewTest, induce);
+};
+
+#endif  // GRAPHVIEW_H_
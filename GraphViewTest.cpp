@@ -0,0 +1,79 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#include <gtest/gtest.h>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "./FptSolver.h"
+#include "./GraphView.h"
+
+// _____________________________________________________________________________
+TEST(GraphViewTest, induce) {
+  Graph full;
+  full.buildFromFile("graph_data/full_graph/canberra.graph", false);
+  Graph file;
+  file.buildFromFile("graph_data/10_random/10_random_00.graph", false);
+
+  // the instance files are subsets of the full graph, find their ids.
+  std::map<string, size_t> ids;
+  for (size_t node = 0; node < full.getNodesNum(); node++) {
+    ids[full.getNodeNames()->at(node)] = node;
+  }
+  vector<size_t> nodes;
+  for (const auto& name : *file.getNodeNames()) {
+    ASSERT_EQ(ids.count(name), 1);
+    nodes.push_back(ids[name]);
+  }
+
+  GraphView view(full);
+  ASSERT_EQ(view.getNodesNum(), 796);
+  Graph sub = view.induce(nodes);
+  ASSERT_TRUE(sub.isSubInstance());
+  ASSERT_FALSE(file.isSubInstance());
+  // the matrix is shared, not copied.
+  ASSERT_EQ(sub._distances.get(), full._distances.get());
+  ASSERT_EQ(sub.getNodesNum(), file.getNodesNum());
+  ASSERT_EQ(*sub.getReleases(), *file.getReleases());
+  ASSERT_EQ(*sub.getDeadlines(), *file.getDeadlines());
+  ASSERT_EQ(*sub.getDurations(), *file.getDurations());
+  ASSERT_EQ(*sub.getPrizes(), *file.getPrizes());
+  ASSERT_EQ(*sub.getNodeNames(), *file.getNodeNames());
+  const uint32_t* columns = sub.matrixColumns();
+  ASSERT_NE(columns, nullptr);
+  for (size_t i = 0; i < sub.getNodesNum(); i++) {
+    const double* row = sub.matrixRow(i);
+    ASSERT_EQ(row, full.distanceRow(nodes[i]));
+    for (size_t j = 0; j < sub.getNodesNum(); j++) {
+      ASSERT_EQ(sub.distance(i, j), file.distance(i, j));
+      ASSERT_EQ(row[columns[j]], file.distance(i, j));
+    }
+  }
+  // the rows of a sub-instance are not contiguous.
+  EXPECT_DEBUG_DEATH(sub.distanceRow(0), "sub-instance");
+
+  // both give the same tour.
+  FptSolver fromFile(file);
+  FptSolver fromView(sub);
+  auto fileSolution = fromFile.solve();
+  auto viewSolution = fromView.solve();
+  ASSERT_EQ(std::get<0>(viewSolution), std::get<0>(fileSolution));
+  vector<Location> fileTour = fromFile.getTour(std::get<1>(fileSolution));
+  vector<Location> viewTour = fromView.getTour(std::get<1>(viewSolution));
+  ASSERT_EQ(viewTour.size(), fileTour.size());
+  for (size_t i = 0; i < fileTour.size(); i++) {
+    ASSERT_EQ(viewTour[i].id, fileTour[i].id);
+  }
+
+  // views of sub-instances map to the full matrix.
+  GraphView subView(sub);
+  Graph subSub = subView.induce({0, 3, 1}, true);
+  ASSERT_EQ(subSub.distance(1, 2), full.distance(nodes[3], nodes[1]));
+  ASSERT_EQ(subSub.distance(2, 0), full.distance(nodes[1], 0));
+  vector<size_t> unitPrizes = {0, 1, 1};
+  ASSERT_EQ(*subSub.getPrizes(), unitPrizes);
+
+  ASSERT_THROW(view.induce({0, 796}), std::out_of_range);
+}
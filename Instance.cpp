@@ -0,0 +1,115 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#include "./Instance.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// _____________________________________________________________________________
+Instance::Instance(Graph graph) {
+  _graph = std::move(graph);
+  _index = SuccessorIndex(_graph);
+  _prohibThresholds = {};
+  _shortestTravel = {};
+}
+
+// _____________________________________________________________________________
+const Graph& Instance::graph() const {
+  return _graph;
+}
+
+// _____________________________________________________________________________
+const SuccessorIndex& Instance::index() const {
+  return _index;
+}
+
+// _____________________________________________________________________________
+bool Instance::checkProhibited(const size_t node1, const size_t node2,
+                               const double time) const {
+  auto release = static_cast<double>((*_graph.getReleases())[node1]);
+  auto duration1 = static_cast<double>((*_graph.getDurations())[node1]);
+  auto duration2 = static_cast<double>((*_graph.getDurations())[node2]);
+  double earliestStart = std::max(time, release + duration1);
+  double travelTime = _graph.distance(node1, node2);
+  double deadline = (*_graph.getDeadlines())[node2];
+  return earliestStart + travelTime + duration2 <= deadline;
+}
+
+// _____________________________________________________________________________
+const vector<double>& Instance::prohibThresholds() const {
+  std::call_once(_thresholdsBuilt, [this]() { initThresholds(); });
+  return _prohibThresholds;
+}
+
+// _____________________________________________________________________________
+const vector<double>& Instance::shortestTravel() const {
+  std::call_once(_travelBuilt, [this]() { initShortestTravel(); });
+  return _shortestTravel;
+}
+
+// _____________________________________________________________________________
+void Instance::initThresholds() const {
+  size_t nodesNum = _graph.getNodesNum();
+  _prohibThresholds.assign(nodesNum * nodesNum,
+                           -std::numeric_limits<double>::infinity());
+  for (size_t node1 = 0; node1 < nodesNum; node1++) {
+    for (size_t node2 = 0; node2 < nodesNum; node2++) {
+      double earliest = (*_graph.getReleases())[node1]
+                        + static_cast<double>((*_graph.getDurations())[node1]);
+      if (!checkProhibited(node1, node2, earliest)) {
+        continue;
+      }
+      // checkProhibited is monotone in time, so it holds exactly up to a
+      // threshold between earliest and the deadline of node2. Bisect on
+      // the bit patterns of the times, which are ordered like the values
+      // for non-negative doubles, to match its rounding exactly.
+      double latest = (*_graph.getDeadlines())[node2] + 1.0;
+      uint64_t low;
+      uint64_t high;
+      std::memcpy(&low, &earliest, sizeof(double));
+      std::memcpy(&high, &latest, sizeof(double));
+      while (high - low > 1) {
+        uint64_t mid = low + (high - low) / 2;
+        double time;
+        std::memcpy(&time, &mid, sizeof(double));
+        if (checkProhibited(node1, node2, time)) {
+          low = mid;
+        } else {
+          high = mid;
+        }
+      }
+      double threshold;
+      std::memcpy(&threshold, &low, sizeof(double));
+      _prohibThresholds[node1 * nodesNum + node2] = threshold;
+    }
+  }
+}
+
+// _____________________________________________________________________________
+void Instance::initShortestTravel() const {
+  size_t nodesNum = _graph.getNodesNum();
+  const size_t* durations = _graph.getDurations()->data();
+  _shortestTravel.assign(nodesNum * nodesNum, 0.0);
+  for (size_t from = 0; from < nodesNum; from++) {
+    for (size_t to = 0; to < nodesNum; to++) {
+      if (from != to) {
+        _shortestTravel[from * nodesNum + to] = durations[from]
+                                                + _graph.distance(from, to);
+      }
+    }
+  }
+  // Floyd-Warshall over the jobs.
+  for (size_t via = 1; via < nodesNum; via++) {
+    const double* viaRow = &_shortestTravel[via * nodesNum];
+    for (size_t from = 0; from < nodesNum; from++) {
+      double* row = &_shortestTravel[from * nodesNum];
+      double toVia = row[via];
+      for (size_t to = 0; to < nodesNum; to++) {
+        row[to] = std::min(row[to], toVia + viaRow[to]);
+      }
+    }
+  }
+}
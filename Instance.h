@@ -0,0 +1,65 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#ifndef INSTANCE_H_
+#define INSTANCE_H_
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "./Graph.h"
+#include "./SuccessorIndex.h"
+
+using std::vector;
+
+// A PC-TW-TSP instance that no longer changes, shared by the solvers
+// through a SharedInstance. Besides the graph it holds the data derived
+// from it, which is computed once per instance instead of once per
+// solver. The successor index is built with the instance, the tables
+// only some solvers need are built on first use. All methods may be
+// called from several threads.
+class Instance {
+ public:
+  // Constructor taking the graph instance.
+  explicit Instance(Graph graph);
+
+  // The graph and its successor index.
+  const Graph& graph() const;
+  const SuccessorIndex& index() const;
+
+  // Method to check whether node2 has to be added to prohibited
+  // jobs of a partial tour ending in node1, that is whether node2 can
+  // still be served after starting the service at node1 at time.
+  bool checkProhibited(size_t node1, size_t node2, double time) const;
+
+  // Row-major table with the latest time for every pair (node1, node2)
+  // up to which checkProhibited(node1, node2, time) holds, or -infinity
+  // if it never holds.
+  const vector<double>& prohibThresholds() const;
+
+  // Row-major table of the shortest time from the start of the service
+  // at node1 to the arrival at node2, serving node1 and any jobs in
+  // between. It differs from the direct time if the distances violate
+  // the triangle inequality. Tours do not pass the start node, so it is
+  // never in between.
+  const vector<double>& shortestTravel() const;
+
+ private:
+  Graph _graph;
+  SuccessorIndex _index;
+
+  // The tables built on first use.
+  mutable vector<double> _prohibThresholds;
+  mutable std::once_flag _thresholdsBuilt;
+  mutable vector<double> _shortestTravel;
+  mutable std::once_flag _travelBuilt;
+
+  // Compute the tables.
+  void initThresholds() const;
+  void initShortestTravel() const;
+};
+
+// The instance shared by all solvers of a graph.
+typedef std::shared_ptr<const Instance> SharedInstance;
+
+#endif  // INSTANCE_H_
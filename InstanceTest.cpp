@@ -0,0 +1,90 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "./Instance.h"
+
+// _____________________________________________________________________________
+TEST(InstanceTest, build) {
+  Graph g;
+  g.buildFromFile("test_data/example_graph4.graph", false);
+  SharedInstance instance = std::make_shared<const Instance>(g);
+  ASSERT_EQ(instance->graph().getNodesNum(), 5);
+  ASSERT_EQ(*instance->graph().getPrizes(), *g.getPrizes());
+  ASSERT_EQ(instance->index().getNodesNum(), 5);
+  ASSERT_EQ(instance->index().latestStart(3), 6);
+  // the tables are built once and then returned as they are.
+  const vector<double>* thresholds = &instance->prohibThresholds();
+  ASSERT_EQ(&instance->prohibThresholds(), thresholds);
+}
+
+// _____________________________________________________________________________
+TEST(InstanceTest, checkProhibited) {
+  Graph g;
+  g.buildFromFile("test_data/example_graph2.graph", true);
+  Instance instance(g);
+  ASSERT_FALSE(instance.checkProhibited(1, 2, 5));
+}
+
+// _____________________________________________________________________________
+TEST(InstanceTest, prohibThresholds) {
+  Graph g;
+  g.buildFromFile("test_data/example_graph3.graph", false);
+  Instance instance(g);
+  size_t n = g.getNodesNum();
+  const vector<double>& thresholds = instance.prohibThresholds();
+  ASSERT_EQ(thresholds.size(), n * n);
+  // node 3 can be left at 645 and node 2 reached at 645.96, the
+  // service there has to end by 840.
+  ASSERT_DOUBLE_EQ(thresholds[3 * n + 2], 840 - 15 - 0.96);
+  // the table agrees with checkProhibited around every threshold.
+  for (size_t node1 = 0; node1 < n; node1++) {
+    for (size_t node2 = 0; node2 < n; node2++) {
+      double threshold = thresholds[node1 * n + node2];
+      for (double time = 600; time < 900; time += 0.5) {
+        ASSERT_EQ(instance.checkProhibited(node1, node2, time),
+                  time <= threshold);
+      }
+      if (std::isfinite(threshold)) {
+        ASSERT_TRUE(instance.checkProhibited(node1, node2, threshold));
+        ASSERT_FALSE(instance.checkProhibited(node1, node2,
+                     std::nextafter(threshold, 1e9)));
+      }
+    }
+  }
+}
+
+// _____________________________________________________________________________
+TEST(InstanceTest, shortestTravel) {
+  Graph g;
+  g.buildFromFile("graph_data/10_random/10_random_00.graph", false);
+  size_t n = g.getNodesNum();
+  const size_t* durations = g.getDurations()->data();
+  // threads asking at the same time get the same table.
+  Instance instance(g);
+  const vector<double>* tables[2];
+  std::thread other([&instance, &tables]() {
+    tables[1] = &instance.shortestTravel();
+  });
+  tables[0] = &instance.shortestTravel();
+  other.join();
+  ASSERT_EQ(tables[0], tables[1]);
+  const vector<double>& travel = *tables[0];
+  ASSERT_EQ(travel.size(), n * n);
+  for (size_t from = 0; from < n; from++) {
+    ASSERT_EQ(travel[from * n + from], 0.0);
+    for (size_t to = 0; to < n; to++) {
+      if (from == to) {continue;}
+      // never longer than going directly or over another job.
+      ASSERT_LE(travel[from * n + to], durations[from] + g.distance(from, to));
+      for (size_t via = 1; via < n; via++) {
+        ASSERT_LE(travel[from * n + to],
+                  travel[from * n + via] + travel[via * n + to] + 1e-9);
+      }
+    }
+  }
+}
@@ -0,0 +1,106 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#include "JobSet.h"
+#include <vector>
+
+// _____________________________________________________________________________
+JobSet::JobSet() {
+  _first = 0;
+  _rest = {};
+}
+
+// _____________________________________________________________________________
+JobSet::JobSet(std::initializer_list<size_t> jobs) {
+  _first = 0;
+  _rest = {};
+  for (auto job : jobs) {
+    insert(job);
+  }
+}
+
+// _____________________________________________________________________________
+void JobSet::insert(const size_t job) {
+  if (job < kWordBits) {
+    _first |= uint64_t(1) << job;
+    return;
+  }
+  size_t idx = job / kWordBits - 1;
+  if (idx >= _rest.size()) {
+    _rest.resize(idx + 1, 0);
+  }
+  _rest[idx] |= uint64_t(1) << (job % kWordBits);
+}
+
+// _____________________________________________________________________________
+size_t JobSet::size() const {
+  size_t num = __builtin_popcountll(_first);
+  for (auto word : _rest) {
+    num += __builtin_popcountll(word);
+  }
+  return num;
+}
+
+// _____________________________________________________________________________
+bool JobSet::empty() const {
+  if (_first != 0) {
+    return false;
+  }
+  for (auto word : _rest) {
+    if (word != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// _____________________________________________________________________________
+bool JobSet::operator==(const JobSet& other) const {
+  return isSubsetOf(other) && other.isSubsetOf(*this);
+}
+
+// _____________________________________________________________________________
+bool JobSet::operator!=(const JobSet& other) const {
+  return !(*this == other);
+}
+
+// _____________________________________________________________________________
+size_t JobSet::capacity() const {
+  return kWordBits * (_rest.size() + 1);
+}
+
+// _____________________________________________________________________________
+size_t JobSet::nextJob(const size_t job) const {
+  size_t end = capacity();
+  size_t idx = job / kWordBits;
+  if (job >= end) {
+    return end;
+  }
+  // mask out the bits below job in the first inspected word.
+  uint64_t word = idx == 0 ? _first : _rest[idx - 1];
+  word &= ~uint64_t(0) << (job % kWordBits);
+  while (word == 0) {
+    idx++;
+    if (idx * kWordBits >= end) {
+      return end;
+    }
+    word = _rest[idx - 1];
+  }
+  return idx * kWordBits + __builtin_ctzll(word);
+}
+
+// _____________________________________________________________________________
+JobSet::const_iterator JobSet::begin() const {
+  return const_iterator(this, nextJob(0));
+}
+
+// _____________________________________________________________________________
+JobSet::const_iterator JobSet::end() const {
+  return const_iterator(this, capacity());
+}
+
+// _____________________________________________________________________________
+JobSet::const_iterator& JobSet::const_iterator::operator++() {
+  _job = _set->nextJob(_job + 1);
+  return *this;
+}
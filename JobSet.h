@@ -0,0 +1,204 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#ifndef JOBSET_H_
+#define JOBSET_H_
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <vector>
+
+using std::vector;
+
+// A compact dynamic bitset of job ids. It is used for the prohibited
+// jobs of a partial tour. The first 64 jobs are stored inline, so sets
+// of the usual instance sizes are copied without heap allocation.
+class JobSet {
+ public:
+  // Forward iterator over the contained job ids in increasing order.
+  class const_iterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef size_t value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const size_t* pointer;
+    typedef const size_t& reference;
+
+    const_iterator(const JobSet* set, size_t job) : _set(set), _job(job) {}
+    size_t operator*() const { return _job; }
+    const_iterator& operator++();
+    bool operator==(const const_iterator& other) const {
+      return _job == other._job;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return _job != other._job;
+    }
+
+   private:
+    const JobSet* _set;
+    size_t _job;
+  };
+
+  // Constructors.
+  JobSet();
+  JobSet(std::initializer_list<size_t> jobs);
+
+  // Adds a job to the set.
+  void insert(size_t job);
+
+  // Returns 1 if the job is in the set and 0 otherwise, like std::set.
+  size_t count(size_t job) const;
+
+  // Number of jobs in the set.
+  size_t size() const;
+  bool empty() const;
+
+  // True if every job of this set is contained in other,
+  // i.e. (this & ~other) == 0 word by word.
+  bool isSubsetOf(const JobSet& other) const;
+
+  // True if the sets share a job, i.e. (this & other) != 0 for a word.
+  bool intersects(const JobSet& other) const;
+
+  // Removes the jobs that are not in other, word by word.
+  void intersectWith(const JobSet& other);
+
+  // Returns the subset of jobs for which keep(job) is true. The result
+  // is built word by word from the bits of the kept jobs, the outcome
+  // of keep does not cause a branch.
+  template <typename Keep>
+  JobSet filter(Keep keep) const;
+
+  // Like filter, but overwrites result, whose words are reused. Sets
+  // with more than 64 jobs are then filtered without allocating.
+  template <typename Keep>
+  void filterInto(Keep keep, JobSet* result) const;
+
+  bool operator==(const JobSet& other) const;
+  bool operator!=(const JobSet& other) const;
+
+  // Hash of the set, equal sets have equal hashes whatever the number
+  // of their trailing empty words.
+  size_t hash() const;
+
+  const_iterator begin() const;
+  const_iterator end() const;
+
+ private:
+  static const size_t kWordBits = 64;
+
+  // Smallest job id >= job contained in the set or the end position.
+  size_t nextJob(size_t job) const;
+
+  // Number of bits that can be stored without growing.
+  size_t capacity() const;
+
+  // Keeps the bits of word for which keep(offset + bit) is true.
+  template <typename Keep>
+  static uint64_t filterWord(uint64_t word, size_t offset, Keep keep);
+
+  uint64_t _first;  // jobs 0 to 63.
+  vector<uint64_t> _rest;  // jobs from 64 on, only allocated if needed.
+  FRIEND_TEST(JobSetTest, insert);
+};
+
+// The membership and subset tests are inlined, they are probed for
+// every label and successor in the FptSolver.
+
+// _____________________________________________________________________________
+inline size_t JobSet::count(const size_t job) const {
+  if (job < kWordBits) {
+    return (_first >> job) & 1;
+  }
+  size_t idx = job / kWordBits - 1;
+  if (idx >= _rest.size()) {
+    return 0;
+  }
+  return (_rest[idx] >> (job % kWordBits)) & 1;
+}
+
+// _____________________________________________________________________________
+inline bool JobSet::isSubsetOf(const JobSet& other) const {
+  if ((_first & ~other._first) != 0) {
+    return false;
+  }
+  for (size_t i = 0; i < _rest.size(); i++) {
+    uint64_t otherWord = i < other._rest.size() ? other._rest[i] : 0;
+    if ((_rest[i] & ~otherWord) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// _____________________________________________________________________________
+inline bool JobSet::intersects(const JobSet& other) const {
+  if ((_first & other._first) != 0) {
+    return true;
+  }
+  size_t words = std::min(_rest.size(), other._rest.size());
+  for (size_t i = 0; i < words; i++) {
+    if ((_rest[i] & other._rest[i]) != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// _____________________________________________________________________________
+inline void JobSet::intersectWith(const JobSet& other) {
+  _first &= other._first;
+  for (size_t i = 0; i < _rest.size(); i++) {
+    _rest[i] &= i < other._rest.size() ? other._rest[i] : 0;
+  }
+}
+
+// _____________________________________________________________________________
+inline size_t JobSet::hash() const {
+  const uint64_t multiplier = 0x9E3779B97F4A7C15ULL;
+  size_t words = _rest.size();
+  while (words > 0 && _rest[words - 1] == 0) {
+    words--;
+  }
+  uint64_t hash = _first * multiplier;
+  for (size_t i = 0; i < words; i++) {
+    hash = (hash ^ _rest[i]) * multiplier;
+  }
+  return static_cast<size_t>(hash ^ (hash >> 32));
+}
+
+// _____________________________________________________________________________
+template <typename Keep>
+JobSet JobSet::filter(Keep keep) const {
+  JobSet result;
+  filterInto(keep, &result);
+  return result;
+}
+
+// _____________________________________________________________________________
+template <typename Keep>
+void JobSet::filterInto(Keep keep, JobSet* result) const {
+  result->_first = filterWord(_first, 0, keep);
+  result->_rest.resize(_rest.size());
+  for (size_t i = 0; i < _rest.size(); i++) {
+    result->_rest[i] = filterWord(_rest[i], (i + 1) * kWordBits, keep);
+  }
+}
+
+// _____________________________________________________________________________
+template <typename Keep>
+uint64_t JobSet::filterWord(uint64_t word, const size_t offset, Keep keep) {
+  uint64_t kept = 0;
+  while (word != 0) {
+    size_t bit = __builtin_ctzll(word);
+    kept |= uint64_t(keep(offset + bit) ? 1 : 0) << bit;
+    word &= word - 1;
+  }
+  return kept;
+}
+
+#endif  // JOBSET_H_
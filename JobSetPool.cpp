@@ -0,0 +1,82 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#include "./JobSetPool.h"
+#include <vector>
+
+const uint32_t JobSetPool::kEmpty;
+
+// _____________________________________________________________________________
+JobSetPool::JobSetPool() {
+  _sets = {};
+  _hashes = {};
+  _slots.assign(16, kEmpty);
+}
+
+// _____________________________________________________________________________
+uint32_t JobSetPool::intern(const JobSet& set) {
+  size_t hash = set.hash();
+  size_t mask = _slots.size() - 1;
+  size_t slot = hash & mask;
+  while (_slots[slot] != kEmpty) {
+    uint32_t id = _slots[slot];
+    if (_hashes[id] == hash && _sets[id] == set) {
+      return id;
+    }
+    slot = (slot + 1) & mask;
+  }
+  uint32_t id = static_cast<uint32_t>(_sets.size());
+  _sets.push_back(set);
+  _hashes.push_back(hash);
+  _slots[slot] = id;
+  if (2 * _sets.size() > _slots.size()) {
+    grow();
+  }
+  return id;
+}
+
+// _____________________________________________________________________________
+size_t JobSetPool::size() const {
+  return _sets.size();
+}
+
+// _____________________________________________________________________________
+void JobSetPool::clear() {
+  _sets.clear();
+  _hashes.clear();
+  _slots.assign(16, kEmpty);
+}
+
+// _____________________________________________________________________________
+void JobSetPool::truncate(const size_t size) {
+  if (size >= _sets.size()) {
+    return;
+  }
+  _sets.resize(size);
+  _hashes.resize(size);
+  _hashes.shrink_to_fit();
+  size_t numSlots = 16;
+  while (2 * size > numSlots) {
+    numSlots *= 2;
+  }
+  rehash(numSlots);
+}
+
+// _____________________________________________________________________________
+void JobSetPool::grow() {
+  rehash(2 * _slots.size());
+}
+
+// _____________________________________________________________________________
+void JobSetPool::rehash(const size_t numSlots) {
+  _slots.assign(numSlots, kEmpty);
+  _slots.shrink_to_fit();
+  size_t mask = _slots.size() - 1;
+  for (uint32_t id = 0; id < _sets.size(); id++) {
+    size_t slot = _hashes[id] & mask;
+    while (_slots[slot] != kEmpty) {
+      slot = (slot + 1) & mask;
+    }
+    _slots[slot] = id;
+  }
+}
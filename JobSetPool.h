@@ -0,0 +1,63 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#ifndef JOBSETPOOL_H_
+#define JOBSETPOOL_H_
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <deque>
+#include <vector>
+#include "./JobSet.h"
+
+using std::vector;
+
+// Hash-consed JobSets. Every distinct set is stored once and referred
+// to by a 32-bit id, so labels with the same prohibited jobs share one
+// set, and two ids are equal exactly if their sets are.
+class JobSetPool {
+ public:
+  // Constructor of an empty pool.
+  JobSetPool();
+
+  // Returns the id of the set, which is added if it is new.
+  uint32_t intern(const JobSet& set);
+
+  // The set with the given id. The sets are stored in a deque, so the
+  // reference stays valid while new sets are interned, up to clear.
+  const JobSet& get(uint32_t id) const { return _sets[id]; }
+
+  // Whether the sets a and b share a job.
+  bool intersects(uint32_t a, uint32_t b) const {
+    return _sets[a].intersects(_sets[b]);
+  }
+
+  // Number of distinct sets.
+  size_t size() const;
+
+  // Removes all sets.
+  void clear();
+
+  // Removes the sets with an id of size or more, the others keep their
+  // ids. The table shrinks with the pool.
+  void truncate(size_t size);
+
+ private:
+  static const uint32_t kEmpty = static_cast<uint32_t>(-1);
+
+  // Doubles the table and inserts all ids again.
+  void grow();
+
+  // Inserts all ids into a new table of the given power of two size.
+  void rehash(size_t numSlots);
+
+  std::deque<JobSet> _sets;
+  vector<size_t> _hashes;  // hash of every set.
+  // Open addressing table of the ids with linear probing. Its size is
+  // a power of two and at most half of it is used.
+  vector<uint32_t> _slots;
+  FRIEND_TEST(JobSetPoolTest, intern);
+  FRIEND_TEST(JobSetPoolTest, truncate);
+};
+
+#endif  // JOBSETPOOL_H_
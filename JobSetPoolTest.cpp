@@ -0,0 +1,63 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "./JobSetPool.h"
+
+// _____________________________________________________________________________
+TEST(JobSetPoolTest, intern) {
+  JobSetPool pool;
+  ASSERT_EQ(pool.size(), 0);
+  uint32_t a = pool.intern({1, 5});
+  uint32_t b = pool.intern({1, 5, 130});
+  ASSERT_NE(a, b);
+  ASSERT_EQ(pool.intern({5, 1}), a);
+  ASSERT_EQ(pool.get(b), JobSet({1, 5, 130}));
+  ASSERT_EQ(pool.size(), 2);
+
+  // equal sets with different word counts share the id.
+  JobSet c = {1, 5, 200};
+  c.intersectWith({1, 5});
+  ASSERT_EQ(pool.intern(c), a);
+
+  // growing the table keeps all ids.
+  for (size_t job = 0; job < 100; job++) {
+    ASSERT_EQ(pool.intern({job, 300}), job + 2);
+  }
+  ASSERT_GE(pool._slots.size(), 2 * pool.size());
+  ASSERT_EQ(pool.intern({1, 5}), a);
+  ASSERT_EQ(pool.intern({42, 300}), 44);
+
+  pool.clear();
+  ASSERT_EQ(pool.size(), 0);
+  ASSERT_EQ(pool.intern({1, 5, 130}), 0);
+}
+
+// _____________________________________________________________________________
+TEST(JobSetPoolTest, intersects) {
+  JobSetPool pool;
+  uint32_t a = pool.intern({1, 5});
+  uint32_t b = pool.intern({1, 5, 130});
+  uint32_t c = pool.intern({2, 130});
+  ASSERT_TRUE(pool.intersects(a, b));
+  ASSERT_TRUE(pool.intersects(b, c));
+  ASSERT_FALSE(pool.intersects(a, c));
+}
+
+// _____________________________________________________________________________
+TEST(JobSetPoolTest, truncate) {
+  JobSetPool pool;
+  for (size_t job = 0; job < 100; job++) {
+    pool.intern({job, 300});
+  }
+  pool.truncate(10);
+  ASSERT_EQ(pool.size(), 10);
+  ASSERT_EQ(pool._slots.size(), 32);
+  ASSERT_EQ(pool.get(9), JobSet({9, 300}));
+  ASSERT_EQ(pool.intern({3, 300}), 3);
+  // removed sets get new ids.
+  ASSERT_EQ(pool.intern({50, 300}), 10);
+  pool.truncate(20);
+  ASSERT_EQ(pool.size(), 11);
+}
@@ -0,0 +1,121 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "./JobSet.h"
+
+// _____________________________________________________________________________
+TEST(JobSetTest, insert) {
+  JobSet s;
+  ASSERT_TRUE(s.empty());
+  s.insert(3);
+  s.insert(63);
+  ASSERT_EQ(s._rest.size(), 0);
+  s.insert(64);
+  s.insert(200);
+  ASSERT_EQ(s._rest.size(), 3);
+  ASSERT_EQ(s.size(), 4);
+  ASSERT_EQ(s.count(3), 1);
+  ASSERT_EQ(s.count(4), 0);
+  ASSERT_EQ(s.count(63), 1);
+  ASSERT_EQ(s.count(64), 1);
+  ASSERT_EQ(s.count(200), 1);
+  ASSERT_EQ(s.count(1000), 0);
+}
+
+// _____________________________________________________________________________
+TEST(JobSetTest, isSubsetOf) {
+  JobSet a = {1, 5};
+  JobSet b = {1, 2, 5};
+  JobSet c = {1, 2, 100};
+  JobSet empty;
+  ASSERT_TRUE(a.isSubsetOf(b));
+  ASSERT_FALSE(b.isSubsetOf(a));
+  ASSERT_TRUE(empty.isSubsetOf(a));
+  ASSERT_FALSE(c.isSubsetOf(b));
+  ASSERT_FALSE(a.isSubsetOf(c));
+  ASSERT_TRUE(b.isSubsetOf(b));
+
+  // trailing empty words do not matter for equality.
+  JobSet d = {1, 2, 100};
+  JobSet e = {1, 2};
+  ASSERT_TRUE(c == d);
+  ASSERT_TRUE(e.isSubsetOf(d));
+  ASSERT_TRUE(e != d);
+}
+
+// _____________________________________________________________________________
+TEST(JobSetTest, intersects) {
+  JobSet a = {1, 5};
+  JobSet b = {2, 5, 130};
+  JobSet c = {2, 130};
+  JobSet d = {3, 200};
+  JobSet empty;
+  ASSERT_TRUE(a.intersects(b));
+  ASSERT_FALSE(a.intersects(c));
+  ASSERT_TRUE(c.intersects(b));
+  ASSERT_TRUE(b.intersects(c));
+  ASSERT_FALSE(b.intersects(d));
+  ASSERT_FALSE(d.intersects(b));
+  ASSERT_FALSE(empty.intersects(a));
+}
+
+// _____________________________________________________________________________
+TEST(JobSetTest, iterate) {
+  JobSet s = {130, 0, 7, 64};
+  vector<size_t> jobs;
+  for (auto job : s) {
+    jobs.push_back(job);
+  }
+  vector<size_t> expected = {0, 7, 64, 130};
+  ASSERT_EQ(jobs, expected);
+
+  JobSet empty;
+  ASSERT_TRUE(empty.begin() == empty.end());
+}
+
+// _____________________________________________________________________________
+TEST(JobSetTest, filter) {
+  JobSet s = {1, 2, 3, 70, 71};
+  JobSet odd = s.filter([](size_t job) { return job % 2 == 1; });
+  JobSet expected = {1, 3, 71};
+  ASSERT_EQ(odd, expected);
+  JobSet none = s.filter([](size_t) { return false; });
+  ASSERT_TRUE(none.empty());
+  ASSERT_EQ(s.filter([](size_t) { return true; }), s);
+
+  // the result is overwritten, whatever it held.
+  JobSet result = {5, 300};
+  s.filterInto([](size_t job) { return job > 2; }, &result);
+  ASSERT_EQ(result, JobSet({3, 70, 71}));
+  JobSet({4}).filterInto([](size_t) { return true; }, &result);
+  ASSERT_EQ(result, JobSet({4}));
+}
+
+// _____________________________________________________________________________
+TEST(JobSetTest, intersectWith) {
+  JobSet s = {1, 5, 70, 200};
+  s.intersectWith({5, 70, 71});
+  JobSet expected = {5, 70};
+  ASSERT_EQ(s, expected);
+  s.intersectWith({1, 2});
+  ASSERT_TRUE(s.empty());
+  JobSet t = {3};
+  t.intersectWith({3, 300});
+  ASSERT_EQ(t, JobSet({3}));
+}
+
+// _____________________________________________________________________________
+TEST(JobSetTest, hash) {
+  JobSet a = {1, 70};
+  JobSet b = {70, 1};
+  ASSERT_EQ(a.hash(), b.hash());
+  // the word of job 200 is left empty again by the intersection.
+  JobSet c = {1, 200};
+  c.intersectWith({1});
+  ASSERT_EQ(c, JobSet({1}));
+  ASSERT_EQ(c.hash(), JobSet({1}).hash());
+  ASSERT_NE(JobSet({1}).hash(), JobSet({2}).hash());
+  ASSERT_NE(JobSet({1}).hash(), a.hash());
+}
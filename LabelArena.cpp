@@ -0,0 +1,77 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#include "./LabelArena.h"
+#include <vector>
+
+// _____________________________________________________________________________
+LabelArena::LabelArena() {
+  _jobs = {};
+  _times = {};
+  _revenues = {};
+  _parents = {};
+  _prohibJobs = {};
+  _cellOffsets = {};
+  _stride = 1;
+  _released = 0;
+}
+
+// _____________________________________________________________________________
+void LabelArena::reset(const size_t nodesNum) {
+  _jobs.clear();
+  _times.clear();
+  _revenues.clear();
+  _parents.clear();
+  _prohibJobs.clear();
+  _cellOffsets.clear();
+  _released = 0;
+  _stride = nodesNum + 1;
+  add(0, 0.0, 0, 0, 0);
+  closeLevel();
+}
+
+// _____________________________________________________________________________
+uint32_t LabelArena::add(const uint32_t job, const double time,
+                         const size_t revenue, const uint32_t parent,
+                         const uint32_t prohibJobs) {
+  _jobs.push_back(job);
+  _times.push_back(time);
+  _revenues.push_back(revenue);
+  _parents.push_back(parent);
+  _prohibJobs.push_back(prohibJobs);
+  return static_cast<uint32_t>(_jobs.size() - 1);
+}
+
+// _____________________________________________________________________________
+void LabelArena::closeLevel() {
+  uint32_t label = _cellOffsets.empty() ? 0 : _cellOffsets.back();
+  uint32_t end = static_cast<uint32_t>(_jobs.size());
+  for (size_t job = 0; job < _stride; job++) {
+    _cellOffsets.push_back(label);
+    while (label < end && _jobs[label] == job) {
+      label++;
+    }
+  }
+}
+
+// _____________________________________________________________________________
+void LabelArena::release(const size_t level) {
+  uint32_t first = levelBegin(level);
+  if (first <= _released) {
+    return;
+  }
+  _revenues.erase(_revenues.begin(), _revenues.begin() + (first - _released));
+  _prohibJobs.erase(_prohibJobs.begin(),
+                    _prohibJobs.begin() + (first - _released));
+  _released = first;
+}
+
+// _____________________________________________________________________________
+size_t LabelArena::numLevels() const {
+  return _cellOffsets.size() / _stride;
+}
+
+// _____________________________________________________________________________
+size_t LabelArena::size() const {
+  return _jobs.size();
+}
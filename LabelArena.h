@@ -0,0 +1,89 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#ifndef LABELARENA_H_
+#define LABELARENA_H_
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <vector>
+
+using std::vector;
+
+// Append-only store of the labels of a solve, level by level. A label is
+// referred to by its handle, its index in the store, which stays valid
+// until reset, so parent links can always be followed. The fields are
+// kept in one array each and a level is appended in the order of its
+// jobs, so the labels of a level and of a (level, job) cell are
+// contiguous and an expansion streams through them.
+class LabelArena {
+ public:
+  // Constructor of an empty arena.
+  LabelArena();
+
+  // Removes all labels. Level 0 then holds the root with handle 0, the
+  // start node of job 0, which is the parent of the labels of level 1.
+  void reset(size_t nodesNum);
+
+  // Appends a label to the open level and returns its handle. The
+  // labels of a level are appended by increasing job.
+  uint32_t add(uint32_t job, double time, size_t revenue, uint32_t parent,
+               uint32_t prohibJobs);
+
+  // Closes the open level, the labels added since the last call.
+  void closeLevel();
+
+  // Frees the revenues and prohibited-set ids of all levels before
+  // level. Their jobs, times and parents stay, so tours can still be
+  // followed through them, 16 bytes per label.
+  void release(size_t level);
+
+  // Number of closed levels, level 0 included.
+  size_t numLevels() const;
+
+  // Number of labels, the root included.
+  size_t size() const;
+
+  // The handles of a level and of a cell are [begin, end).
+  uint32_t levelBegin(size_t level) const {
+    return _cellOffsets[level * _stride];
+  }
+  uint32_t levelEnd(size_t level) const {
+    return _cellOffsets[level * _stride + _stride - 1];
+  }
+  uint32_t cellBegin(size_t level, size_t job) const {
+    return _cellOffsets[level * _stride + job];
+  }
+  uint32_t cellEnd(size_t level, size_t job) const {
+    return _cellOffsets[level * _stride + job + 1];
+  }
+
+  // The fields of a label.
+  uint32_t job(uint32_t label) const { return _jobs[label]; }
+  double time(uint32_t label) const { return _times[label]; }
+  size_t revenue(uint32_t label) const {
+    return _revenues[label - _released];
+  }
+  uint32_t parent(uint32_t label) const { return _parents[label]; }
+  uint32_t prohibJobs(uint32_t label) const {
+    return _prohibJobs[label - _released];
+  }
+
+ private:
+  vector<uint32_t> _jobs;
+  vector<double> _times;
+  vector<size_t> _revenues;
+  vector<uint32_t> _parents;
+  vector<uint32_t> _prohibJobs;
+  // The first label whose revenue and prohibited jobs are still kept.
+  uint32_t _released;
+
+  // Row level of nodesNum + 1 offsets, the first label of every job and
+  // the end of the level.
+  vector<uint32_t> _cellOffsets;
+  size_t _stride;
+  FRIEND_TEST(LabelArenaTest, add);
+  FRIEND_TEST(LabelArenaTest, release);
+};
+
+#endif  // LABELARENA_H_
@@ -0,0 +1,84 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "./LabelArena.h"
+
+// _____________________________________________________________________________
+TEST(LabelArenaTest, add) {
+  LabelArena arena;
+  ASSERT_EQ(arena.numLevels(), 0);
+  arena.reset(4);
+  ASSERT_EQ(arena.numLevels(), 1);
+  ASSERT_EQ(arena.size(), 1);
+  ASSERT_EQ(arena.levelBegin(0), 0);
+  ASSERT_EQ(arena.levelEnd(0), 1);
+  ASSERT_EQ(arena.job(0), 0);
+
+  // level 1 has no label of job 2.
+  ASSERT_EQ(arena.add(1, 4.0, 1, 0, 7), 1);
+  ASSERT_EQ(arena.add(3, 2.0, 5, 0, 8), 2);
+  ASSERT_EQ(arena.add(3, 6.0, 6, 0, 9), 3);
+  arena.closeLevel();
+  ASSERT_EQ(arena.numLevels(), 2);
+  ASSERT_EQ(arena._cellOffsets,
+            vector<uint32_t>({0, 1, 1, 1, 1, 1, 1, 2, 2, 4}));
+  ASSERT_EQ(arena.levelBegin(1), 1);
+  ASSERT_EQ(arena.levelEnd(1), 4);
+  ASSERT_EQ(arena.cellBegin(1, 2), arena.cellEnd(1, 2));
+  ASSERT_EQ(arena.cellBegin(1, 3), 2);
+  ASSERT_EQ(arena.cellEnd(1, 3), 4);
+
+  // handles stay valid while levels are appended.
+  uint32_t label = arena.add(1, 9.0, 11, 3, 10);
+  arena.closeLevel();
+  ASSERT_EQ(arena.time(label), 9.0);
+  ASSERT_EQ(arena.revenue(label), 11);
+  ASSERT_EQ(arena.parent(label), 3);
+  ASSERT_EQ(arena.prohibJobs(label), 10);
+  ASSERT_EQ(arena.job(arena.parent(label)), 3);
+  ASSERT_EQ(arena.time(3), 6.0);
+  ASSERT_EQ(arena.levelBegin(2), 4);
+  ASSERT_EQ(arena.levelEnd(2), 5);
+
+  // an empty level.
+  arena.closeLevel();
+  ASSERT_EQ(arena.levelBegin(3), arena.levelEnd(3));
+
+  arena.reset(2);
+  ASSERT_EQ(arena.size(), 1);
+  ASSERT_EQ(arena.numLevels(), 1);
+}
+
+// _____________________________________________________________________________
+TEST(LabelArenaTest, release) {
+  LabelArena arena;
+  arena.reset(3);
+  arena.add(1, 1.0, 2, 0, 5);
+  arena.add(2, 3.0, 4, 0, 6);
+  arena.closeLevel();
+  uint32_t label = arena.add(2, 7.0, 9, 1, 8);
+  arena.closeLevel();
+  arena.release(2);
+  ASSERT_EQ(arena._released, 3);
+  ASSERT_EQ(arena._revenues.size(), 1);
+  ASSERT_EQ(arena.revenue(label), 9);
+  ASSERT_EQ(arena.prohibJobs(label), 8);
+  // released labels can still be followed.
+  ASSERT_EQ(arena.parent(label), 1);
+  ASSERT_EQ(arena.job(1), 1);
+  ASSERT_EQ(arena.time(1), 1.0);
+  ASSERT_EQ(arena.size(), 4);
+
+  // labels added later are found as well.
+  label = arena.add(1, 8.0, 10, label, 11);
+  arena.closeLevel();
+  ASSERT_EQ(arena.revenue(label), 10);
+  arena.release(1);
+  ASSERT_EQ(arena._revenues.size(), 2);
+
+  arena.reset(3);
+  ASSERT_EQ(arena._released, 0);
+  ASSERT_EQ(arena.revenue(0), 0);
+}
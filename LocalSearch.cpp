@@ -0,0 +1,515 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#include "./LocalSearch.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Tolerance of the slack comparisons, the slacks are differences of
+// times and may be off by rounding.
+static const double kEpsilon = 1e-9;
+
+// _____________________________________________________________________________
+LocalSearchOptions::LocalSearchOptions() {
+  timeLimit = 1.0;
+  rounds = 0;
+  kickSize = 2;
+  seed = 0;
+}
+
+// _____________________________________________________________________________
+LocalSearch::LocalSearch(Graph graph, LocalSearchOptions options)
+    : LocalSearch(std::make_shared<const Instance>(std::move(graph)),
+                  options) {
+}
+
+// _____________________________________________________________________________
+LocalSearch::LocalSearch(SharedInstance instance, LocalSearchOptions options) {
+  _instance = instance;
+  _graph = &_instance->graph();
+  _index = &_instance->index();
+  _options = options;
+  _random.seed(options.seed);
+  _tour = {};
+  _arrivals = {};
+  _slacks = {};
+  _onTour = {};
+  _kicked = {};
+  _prize = 0;
+  _travel = 0;
+  _bestTour = {};
+  _bestPrize = 0;
+  _bestTravel = 0;
+}
+
+// _____________________________________________________________________________
+size_t LocalSearch::solve(const vector<Location>& tour) {
+  const size_t nodesNum = _graph->getNodesNum();
+  for (const auto& loc : tour) {
+    if (loc.id == 0 || loc.id >= nodesNum) {
+      throw std::out_of_range("location " + std::to_string(loc.id)
+                              + " can not be part of a tour");
+    }
+  }
+  auto deadline = std::chrono::steady_clock::now()
+                  + std::chrono::duration_cast<
+                      std::chrono::steady_clock::duration>(
+                      std::chrono::duration<double>(_options.timeLimit));
+
+  // the start tour keeps every job that fits after the ones before.
+  _tour.clear();
+  _onTour.assign(nodesNum, 0);
+  _kicked.assign(nodesNum, 0);
+  schedule();
+  for (const auto& loc : tour) {
+    if (!_onTour[loc.id] && _index->servable(loc.id)
+        && insertFits(loc.id, _tour.size())) {
+      _tour.push_back(loc.id);
+      _onTour[loc.id] = 1;
+      schedule();
+    }
+  }
+
+  descend();
+  _bestTour = _tour;
+  _bestPrize = _prize;
+  _bestTravel = _travel;
+  for (size_t round = 0;
+       _options.rounds == 0 || round < _options.rounds; round++) {
+    if (std::chrono::steady_clock::now() >= deadline) {
+      break;
+    }
+    perturb();
+    descend();
+    // the removed jobs may return once the tour settled without them.
+    std::fill(_kicked.begin(), _kicked.end(), 0);
+    descend();
+    if (betterThanBest()) {
+      _bestTour = _tour;
+      _bestPrize = _prize;
+      _bestTravel = _travel;
+    } else if (_prize < _bestPrize) {
+      // a worse local optimum is left, ties are kept to move on.
+      _tour = _bestTour;
+      _onTour.assign(nodesNum, 0);
+      for (size_t job : _tour) {
+        _onTour[job] = 1;
+      }
+      schedule();
+    }
+  }
+  return _bestPrize;
+}
+
+// _____________________________________________________________________________
+vector<Location> LocalSearch::getTour() const {
+  vector<Location> path;
+  double leave = 0;
+  size_t previous = 0;
+  for (size_t job : _bestTour) {
+    double arrival = std::max(_index->earliestStart(job),
+                              leave + travel(previous, job));
+    leave = arrival + _graph->getDurations()->at(job);
+    auto geoLoc = _graph->getLocations()->at(job);
+    Location node = {job, _graph->getPrizes()->at(job), arrival, leave,
+                     std::get<0>(geoLoc), std::get<1>(geoLoc),
+                     _graph->getNodeNames()->at(job)};
+    path.push_back(node);
+    previous = job;
+  }
+  return path;
+}
+
+// _____________________________________________________________________________
+void LocalSearch::schedule() {
+  const size_t* prizes = _graph->getPrizes()->data();
+  const size_t* durations = _graph->getDurations()->data();
+  const size_t size = _tour.size();
+  _arrivals.resize(size);
+  _slacks.resize(size);
+  _prize = 0;
+  _travel = 0;
+  for (size_t pos = 0; pos < size; pos++) {
+    size_t job = _tour[pos];
+    _arrivals[pos] = std::max(_index->earliestStart(job),
+                              reachAfter(pos == 0 ? npos : pos - 1, job));
+    _prize += prizes[job];
+    _travel += travel(pos == 0 ? 0 : _tour[pos - 1], job);
+  }
+
+  // a delay at a position is absorbed by the waiting before the next
+  // one, the rest of it moves the next arrival.
+  for (size_t pos = size; pos-- > 0;) {
+    size_t job = _tour[pos];
+    _slacks[pos] = _index->latestStart(job) - _arrivals[pos];
+    if (pos + 1 < size) {
+      double wait = _arrivals[pos + 1] - _arrivals[pos] - durations[job]
+                    - travel(job, _tour[pos + 1]);
+      _slacks[pos] = std::min(_slacks[pos], wait + _slacks[pos + 1]);
+    }
+  }
+}
+
+// _____________________________________________________________________________
+double LocalSearch::reachAfter(size_t pos, size_t job) const {
+  if (pos == npos) {
+    return 0;
+  }
+  size_t previous = _tour[pos];
+  return _arrivals[pos] + _graph->getDurations()->at(previous)
+         + _graph->distance(previous, job);
+}
+
+// _____________________________________________________________________________
+bool LocalSearch::delayFits(size_t pos, double reach) const {
+  if (pos >= _tour.size()) {
+    return true;
+  }
+  double arrival = std::max(_index->earliestStart(_tour[pos]), reach);
+  return arrival - _arrivals[pos] <= _slacks[pos] + kEpsilon;
+}
+
+// _____________________________________________________________________________
+bool LocalSearch::insertFits(size_t job, size_t pos) const {
+  double arrival = std::max(_index->earliestStart(job),
+                            reachAfter(pos == 0 ? npos : pos - 1, job));
+  if (arrival > _index->latestStart(job)) {
+    return false;
+  }
+  if (pos == _tour.size()) {
+    return true;
+  }
+  return delayFits(pos, arrival + _graph->getDurations()->at(job)
+                        + _graph->distance(job, _tour[pos]));
+}
+
+// _____________________________________________________________________________
+bool LocalSearch::replaceFits(size_t job, size_t pos) const {
+  double arrival = std::max(_index->earliestStart(job),
+                            reachAfter(pos == 0 ? npos : pos - 1, job));
+  if (arrival > _index->latestStart(job)) {
+    return false;
+  }
+  if (pos + 1 == _tour.size()) {
+    return true;
+  }
+  return delayFits(pos + 1, arrival + _graph->getDurations()->at(job)
+                            + _graph->distance(job, _tour[pos + 1]));
+}
+
+// _____________________________________________________________________________
+bool LocalSearch::removeFits(size_t pos) const {
+  if (pos + 1 == _tour.size()) {
+    return true;
+  }
+  return delayFits(pos + 1, reachAfter(pos == 0 ? npos : pos - 1,
+                                       _tour[pos + 1]));
+}
+
+// _____________________________________________________________________________
+double LocalSearch::travel(size_t from, size_t to) const {
+  if (from == 0 || to == 0) {
+    return 0;
+  }
+  return _graph->distance(from, to);
+}
+
+// _____________________________________________________________________________
+bool LocalSearch::insertJob() {
+  const size_t* prizes = _graph->getPrizes()->data();
+  const size_t size = _tour.size();
+  size_t bestJob = 0;
+  size_t bestPos = 0;
+  size_t bestPrize = 0;
+  double bestDelta = 0;
+  for (size_t job = 1; job < _graph->getNodesNum(); job++) {
+    if (_onTour[job] || _kicked[job] || !_index->servable(job)
+        || prizes[job] < bestPrize || prizes[job] == 0) {
+      continue;
+    }
+    for (size_t pos = 0; pos <= size; pos++) {
+      size_t previous = pos == 0 ? 0 : _tour[pos - 1];
+      size_t next = pos == size ? 0 : _tour[pos];
+      double delta = travel(previous, job) + travel(job, next)
+                     - travel(previous, next);
+      if ((prizes[job] == bestPrize && delta >= bestDelta)
+          || !insertFits(job, pos)) {
+        continue;
+      }
+      bestJob = job;
+      bestPos = pos;
+      bestPrize = prizes[job];
+      bestDelta = delta;
+    }
+  }
+  if (bestJob == 0) {
+    return false;
+  }
+  _tour.insert(_tour.begin() + bestPos, bestJob);
+  _onTour[bestJob] = 1;
+  schedule();
+  return true;
+}
+
+// _____________________________________________________________________________
+bool LocalSearch::swapJob() {
+  const size_t* prizes = _graph->getPrizes()->data();
+  const size_t size = _tour.size();
+  size_t bestJob = 0;
+  size_t bestPos = 0;
+  size_t bestGain = 0;
+  double bestDelta = -kEpsilon;
+  for (size_t pos = 0; pos < size; pos++) {
+    size_t old = _tour[pos];
+    size_t previous = pos == 0 ? 0 : _tour[pos - 1];
+    size_t next = pos + 1 == size ? 0 : _tour[pos + 1];
+    double removed = travel(previous, old) + travel(old, next);
+    for (size_t job = 1; job < _graph->getNodesNum(); job++) {
+      // a swap gains prize or, at the same prize, travel time.
+      if (_onTour[job] || _kicked[job] || !_index->servable(job)
+          || prizes[job] < prizes[old]
+          || prizes[job] - prizes[old] < bestGain) {
+        continue;
+      }
+      size_t gain = prizes[job] - prizes[old];
+      double delta = travel(previous, job) + travel(job, next) - removed;
+      if ((gain == bestGain && delta >= bestDelta)
+          || !replaceFits(job, pos)) {
+        continue;
+      }
+      bestJob = job;
+      bestPos = pos;
+      bestGain = gain;
+      bestDelta = delta;
+    }
+  }
+  if (bestJob == 0) {
+    return false;
+  }
+  _onTour[_tour[bestPos]] = 0;
+  _tour[bestPos] = bestJob;
+  _onTour[bestJob] = 1;
+  schedule();
+  return true;
+}
+
+// _____________________________________________________________________________
+double LocalSearch::latestArrival(size_t pos) const {
+  return _arrivals[pos] + _slacks[pos];
+}
+
+// _____________________________________________________________________________
+bool LocalSearch::relocateJob() {
+  const size_t* durations = _graph->getDurations()->data();
+  const size_t size = _tour.size();
+  for (size_t pos = 0; pos < size; pos++) {
+    if (!removeFits(pos)) {
+      continue;
+    }
+    size_t job = _tour[pos];
+    size_t previous = pos == 0 ? 0 : _tour[pos - 1];
+    size_t next = pos + 1 == size ? 0 : _tour[pos + 1];
+    double removed = travel(previous, job) + travel(job, next)
+                     - travel(previous, next);
+    // the job is inserted between before and after.
+    // whether the job fits if it is reached at reach and after, which
+    // may start at latest at the latest, follows it.
+    auto fits = [this, job, durations](double reach, size_t after,
+                                       double latest) {
+      double arrival = std::max(_index->earliestStart(job), reach);
+      if (arrival > _index->latestStart(job)) {
+        return false;
+      }
+      if (after == 0) {
+        return true;
+      }
+      double onward = arrival + durations[job] + _graph->distance(job, after);
+      return std::max(_index->earliestStart(after), onward)
+             <= latest + kEpsilon;
+    };
+    size_t bestTo = npos;
+    double bestDelta = -kEpsilon;
+
+    // later targets. Without the job the positions after it are reached
+    // earlier, their arrivals are carried along the tour.
+    double arrival = 0;
+    if (pos + 1 < size) {
+      arrival = std::max(_index->earliestStart(next),
+                         reachAfter(pos == 0 ? npos : pos - 1, next));
+    }
+    for (size_t to = pos + 1; to < size; to++) {
+      size_t before = _tour[to];
+      size_t after = to + 1 == size ? 0 : _tour[to + 1];
+      double leave = arrival + durations[before];
+      double delta = travel(before, job) + travel(job, after)
+                     - travel(before, after) - removed;
+      if (delta < bestDelta
+          && fits(leave + _graph->distance(before, job), after,
+                  after == 0 ? 0 : latestArrival(to + 1))) {
+        bestTo = to + 1;
+        bestDelta = delta;
+      }
+      if (after != 0) {
+        arrival = std::max(_index->earliestStart(after),
+                           leave + _graph->distance(before, after));
+      }
+    }
+
+    // earlier targets. Without the job the positions before it may
+    // start later, their latest arrivals are carried back the tour.
+    double latest = 0;
+    if (pos > 0) {
+      latest = _index->latestStart(previous);
+      if (pos + 1 < size) {
+        latest = std::min(latest, latestArrival(pos + 1) - durations[previous]
+                                  - _graph->distance(previous, next));
+      }
+    }
+    for (size_t to = pos; to-- > 0;) {
+      size_t before = to == 0 ? 0 : _tour[to - 1];
+      size_t after = _tour[to];
+      double delta = travel(before, job) + travel(job, after)
+                     - travel(before, after) - removed;
+      if (delta < bestDelta
+          && fits(reachAfter(to == 0 ? npos : to - 1, job), after, latest)) {
+        bestTo = to;
+        bestDelta = delta;
+      }
+      if (before != 0) {
+        latest = std::min(_index->latestStart(before),
+                          latest - durations[before]
+                          - _graph->distance(before, after));
+      }
+    }
+
+    if (bestTo != npos) {
+      _tour.erase(_tour.begin() + pos);
+      _tour.insert(_tour.begin() + (bestTo > pos ? bestTo - 1 : bestTo), job);
+      schedule();
+      return true;
+    }
+  }
+  return false;
+}
+
+// _____________________________________________________________________________
+bool LocalSearch::exchangeJobs() {
+  const size_t* durations = _graph->getDurations()->data();
+  const size_t size = _tour.size();
+  size_t bestFirst = 0;
+  size_t bestSecond = 0;
+  double bestDelta = -kEpsilon;
+  for (size_t first = 0; first + 1 < size; first++) {
+    size_t firstJob = _tour[first];
+    size_t previous = first == 0 ? 0 : _tour[first - 1];
+    // the jobs between the two positions keep their order. Reached at
+    // time t, the last of them starts at max(earliest, t + span) and
+    // they all stay in their windows if t <= latest.
+    double earliest = 0;
+    double span = 0;
+    double latest = 0;
+    for (size_t second = first + 1; second < size; second++) {
+      size_t secondJob = _tour[second];
+      size_t next = second + 1 == size ? 0 : _tour[second + 1];
+      size_t last = _tour[second - 1];
+      double delta;
+      if (second == first + 1) {
+        delta = travel(previous, secondJob) + travel(secondJob, firstJob)
+                + travel(firstJob, next) - travel(previous, firstJob)
+                - travel(firstJob, secondJob) - travel(secondJob, next);
+      } else {
+        size_t middle = _tour[first + 1];
+        delta = travel(previous, secondJob) + travel(secondJob, middle)
+                + travel(last, firstJob) + travel(firstJob, next)
+                - travel(previous, firstJob) - travel(firstJob, middle)
+                - travel(last, secondJob) - travel(secondJob, next);
+        // the jobs between now end with last.
+        if (second == first + 2) {
+          earliest = _index->earliestStart(middle);
+          span = 0;
+          latest = _index->latestStart(middle);
+        } else {
+          size_t beforeLast = _tour[second - 2];
+          double step = durations[beforeLast]
+                        + _graph->distance(beforeLast, last);
+          span += step;
+          earliest = std::max(_index->earliestStart(last), earliest + step);
+          latest = std::min(latest, _index->latestStart(last) - span);
+        }
+      }
+      if (delta >= bestDelta) {
+        continue;
+      }
+
+      // the second job takes the first position.
+      double arrival = std::max(_index->earliestStart(secondJob),
+          reachAfter(first == 0 ? npos : first - 1, secondJob));
+      if (arrival > _index->latestStart(secondJob)) {
+        continue;
+      }
+      size_t from = secondJob;
+      if (second > first + 1) {
+        size_t middle = _tour[first + 1];
+        double reach = arrival + durations[secondJob]
+                       + _graph->distance(secondJob, middle);
+        if (reach > latest) {
+          continue;
+        }
+        arrival = std::max(earliest, reach + span);
+        from = last;
+      }
+      // the first job takes the second position.
+      arrival = std::max(_index->earliestStart(firstJob),
+                         arrival + durations[from]
+                         + _graph->distance(from, firstJob));
+      if (arrival > _index->latestStart(firstJob)) {
+        continue;
+      }
+      if (next != 0
+          && !delayFits(second + 1, arrival + durations[firstJob]
+                                    + _graph->distance(firstJob, next))) {
+        continue;
+      }
+      bestFirst = first;
+      bestSecond = second;
+      bestDelta = delta;
+    }
+  }
+  if (bestDelta >= -kEpsilon) {
+    return false;
+  }
+  std::swap(_tour[bestFirst], _tour[bestSecond]);
+  schedule();
+  return true;
+}
+
+// _____________________________________________________________________________
+void LocalSearch::descend() {
+  while (insertJob() || swapJob() || relocateJob() || exchangeJobs()) {
+  }
+}
+
+// _____________________________________________________________________________
+void LocalSearch::perturb() {
+  for (size_t kick = 0; kick < _options.kickSize && !_tour.empty(); kick++) {
+    std::uniform_int_distribution<size_t> position(0, _tour.size() - 1);
+    size_t pos = position(_random);
+    if (!removeFits(pos)) {
+      continue;
+    }
+    _onTour[_tour[pos]] = 0;
+    _kicked[_tour[pos]] = 1;
+    _tour.erase(_tour.begin() + pos);
+    schedule();
+  }
+}
+
+// _____________________________________________________________________________
+bool LocalSearch::betterThanBest() const {
+  return _prize > _bestPrize
+         || (_prize == _bestPrize && _travel < _bestTravel - kEpsilon);
+}
@@ -0,0 +1,137 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#ifndef LOCALSEARCH_H_
+#define LOCALSEARCH_H_
+
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "./Graph.h"
+#include "./Instance.h"
+
+using std::vector;
+
+// Options of the LocalSearch.
+struct LocalSearchOptions {
+  // Constructor.
+  LocalSearchOptions();
+
+  // Seconds the search may take in total.
+  double timeLimit;
+
+  // Rounds of perturbation and descent, 0 runs until the time limit.
+  size_t rounds;
+
+  // Jobs removed from the tour by a perturbation.
+  size_t kickSize;
+
+  // Seed of the random perturbations.
+  unsigned seed;
+};
+
+// Iterated local search for the PC_TW_TSP. It improves a feasible tour
+// by inserting jobs, swapping a tour job for a better one off the tour,
+// relocating a job and exchanging the positions of two tour jobs, and
+// escapes local optima by removing a few random jobs. Along the tour it
+// keeps the earliest arrival at each job and the forward slack, the
+// delay of that arrival the rest of the tour can absorb. So every
+// candidate move is checked for feasibility in constant time, and the
+// tour is only scheduled again once a move is applied.
+class LocalSearch {
+ public:
+  // Constructors. Searches of the same shared instance reuse its
+  // successor index.
+  explicit LocalSearch(Graph graph,
+                       LocalSearchOptions options = LocalSearchOptions());
+  explicit LocalSearch(SharedInstance instance,
+                       LocalSearchOptions options = LocalSearchOptions());
+
+  // Improves the tour and returns the prize of the best tour found.
+  // Only the ids of the locations are used, the times are recomputed as
+  // early as possible. Jobs that do not fit after the jobs before them
+  // are dropped, so any order of jobs is a valid start, the empty one
+  // included. Ids outside the jobs throw std::out_of_range.
+  size_t solve(const vector<Location>& tour);
+
+  // The best tour found by the last solve.
+  vector<Location> getTour() const;
+
+ private:
+  // Recomputes the arrivals, slacks, prize and travel time of the tour.
+  void schedule();
+  FRIEND_TEST(LocalSearchTest, schedule);
+
+  // Time the job is reached after serving the tour position pos, 0 for
+  // pos == npos as a tour starts at any job without travelling. The
+  // service starts at the later of this time and the release.
+  double reachAfter(size_t pos, size_t job) const;
+
+  // Whether the rest of the tour stays feasible if the position pos is
+  // reached at the given time. Compares the delay with the slack.
+  bool delayFits(size_t pos, double reach) const;
+
+  // Whether the tour stays feasible if the job is inserted before the
+  // position pos, pos == size() appends it. Constant time.
+  bool insertFits(size_t job, size_t pos) const;
+  // Whether the tour stays feasible if the job replaces position pos.
+  bool replaceFits(size_t job, size_t pos) const;
+  // Whether the tour stays feasible without position pos.
+  bool removeFits(size_t pos) const;
+  FRIEND_TEST(LocalSearchTest, fits);
+
+  // Latest arrival at position pos from which the rest of the tour
+  // stays feasible.
+  double latestArrival(size_t pos) const;
+
+  // Travel time between two jobs, 0 for the open ends of the tour,
+  // which are passed as job 0.
+  double travel(size_t from, size_t to) const;
+
+  // The moves of the descent. Each one applies the best improving move
+  // of its kind and returns whether there was one. A swap replaces a
+  // tour job with one off the tour, a relocation moves the first job
+  // that can be moved to its best position and an exchange swaps the
+  // positions of two tour jobs.
+  bool insertJob();
+  bool swapJob();
+  bool relocateJob();
+  bool exchangeJobs();
+  FRIEND_TEST(LocalSearchTest, moves);
+
+  // Applies moves until none improves the tour.
+  void descend();
+
+  // Removes kickSize random jobs and marks them as kicked.
+  void perturb();
+
+  // Whether the current tour is better than the best one, by prize and
+  // then by travel time.
+  bool betterThanBest() const;
+
+  static const size_t npos = static_cast<size_t>(-1);
+
+  SharedInstance _instance;
+  const Graph* _graph;
+  const SuccessorIndex* _index;
+  LocalSearchOptions _options;
+  std::mt19937 _random;
+
+  // The current tour, the earliest arrival at each position and its
+  // forward slack.
+  vector<size_t> _tour;
+  vector<double> _arrivals;
+  vector<double> _slacks;
+  vector<char> _onTour;
+  // Jobs removed by the last perturbation, they stay off the tour for
+  // the first descent after it.
+  vector<char> _kicked;
+  size_t _prize;
+  double _travel;
+
+  vector<size_t> _bestTour;
+  size_t _bestPrize;
+  double _bestTravel;
+};
+
+#endif  // LOCALSEARCH_H_
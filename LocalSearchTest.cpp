@@ -0,0 +1,205 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "./FptSolver.h"
+#include "./LocalSearch.h"
+
+// Asserts that the tour keeps all time windows and travel times and
+// that its prize is the one reported.
+static void assertValid(const Graph& g, const vector<Location>& tour,
+                        size_t prize) {
+  size_t sum = 0;
+  for (size_t i = 0; i < tour.size(); i++) {
+    size_t job = tour[i].id;
+    ASSERT_GE(tour[i].arrival, g.getReleases()->at(job));
+    ASSERT_LE(tour[i].leave, g.getDeadlines()->at(job) + 1e-6);
+    if (i > 0) {
+      ASSERT_GE(tour[i].arrival + 1e-6,
+                tour[i - 1].leave + g.distance(tour[i - 1].id, job));
+    }
+    sum += tour[i].prize;
+  }
+  ASSERT_EQ(sum, prize);
+}
+
+// _____________________________________________________________________________
+TEST(LocalSearchTest, schedule) {
+  Graph g;
+  g.buildFromFile("test_data/example_graph4.graph", false);
+  LocalSearch search(g);
+  search._tour = {2, 3};
+  search.schedule();
+  ASSERT_EQ(search._arrivals, vector<double>({0, 6}));
+  // node3 has to start at 6, node2 can not wait for it.
+  ASSERT_EQ(search._slacks, vector<double>({0, 0}));
+  ASSERT_EQ(search._prize, 9);
+  ASSERT_EQ(search._travel, 5);
+
+  search._tour = {2, 4};
+  search.schedule();
+  ASSERT_EQ(search._arrivals, vector<double>({0, 8}));
+  ASSERT_EQ(search._slacks, vector<double>({3, 5}));
+}
+
+// _____________________________________________________________________________
+TEST(LocalSearchTest, fits) {
+  Graph g;
+  g.buildFromFile("test_data/example_graph4.graph", false);
+  LocalSearch search(g);
+  search._tour = {2, 3};
+  search.schedule();
+  ASSERT_TRUE(search.insertFits(4, 2));
+  // node1 fits itself but delays node3.
+  ASSERT_FALSE(search.insertFits(1, 1));
+  ASSERT_FALSE(search.insertFits(4, 0));
+  ASSERT_FALSE(search.replaceFits(1, 0));
+  ASSERT_TRUE(search.replaceFits(4, 1));
+  ASSERT_TRUE(search.removeFits(0));
+  ASSERT_TRUE(search.removeFits(1));
+}
+
+// _____________________________________________________________________________
+TEST(LocalSearchTest, solve) {
+  Graph g;
+  g.buildFromFile("test_data/example_graph4.graph", false);
+  LocalSearchOptions options;
+  options.rounds = 20;
+  LocalSearch search(g, options);
+  ASSERT_EQ(search.solve({}), 12);
+  vector<Location> tour = search.getTour();
+  ASSERT_EQ(tour.size(), 3);
+  ASSERT_EQ(tour[0].id, 2);
+  ASSERT_EQ(tour[1].id, 3);
+  ASSERT_EQ(tour[2].id, 4);
+  ASSERT_EQ(tour[2].arrival, 13);
+  assertValid(g, tour, 12);
+
+  // a start tour that does not fit is repaired.
+  Location one = {1, 1, 0, 0, 0, 0, "node1"};
+  Location three = {3, 6, 0, 0, 0, 0, "node3"};
+  ASSERT_EQ(search.solve({one, three}), 12);
+
+  Location outside = {5, 1, 0, 0, 0, 0, "outside"};
+  ASSERT_THROW(search.solve({one, outside}), std::out_of_range);
+}
+
+// _____________________________________________________________________________
+TEST(LocalSearchTest, solveGraphData) {
+  for (const string size : {"15", "25"}) {
+    for (const string kind : {"_cluster", "_random"}) {
+      for (const string number : {"00", "01", "02"}) {
+        Graph g;
+        g.buildFromFile("graph_data/" + size + kind + "/" + size + kind + "_"
+                        + number + ".graph");
+        FptSolver fpt(g);
+        auto result = fpt.solve();
+        size_t optimum = std::get<0>(result);
+
+        LocalSearchOptions options;
+        options.rounds = 50;
+        LocalSearch search(g, options);
+        size_t prize = search.solve({});
+        ASSERT_LE(prize, optimum);
+        assertValid(g, search.getTour(), prize);
+
+        // an optimal start tour is never made worse.
+        ASSERT_EQ(search.solve(fpt.getTour(std::get<1>(result))), optimum);
+        assertValid(g, search.getTour(), optimum);
+      }
+    }
+  }
+}
+
+// _____________________________________________________________________________
+TEST(LocalSearchTest, moves) {
+  vector<string> files;
+  for (const string size : {"10", "15", "20", "25"}) {
+    for (const string kind : {"_cluster", "_random"}) {
+      for (const string number : {"00", "01", "02"}) {
+        files.push_back("graph_data/" + size + kind + "/" + size + kind + "_"
+                        + number + ".graph");
+      }
+    }
+  }
+  for (const string& file : files) {
+    Graph g;
+    g.buildFromFile(file);
+    LocalSearch search(g);
+    // schedules tours from scratch to compare the moves with.
+    LocalSearch check(g);
+    auto feasible = [&check](const vector<size_t>& tour, double* travel) {
+      check._tour = tour;
+      check.schedule();
+      *travel = check._travel;
+      for (double slack : check._slacks) {
+        if (slack < -1e-9) {return false;}
+      }
+      return true;
+    };
+
+    std::mt19937 random(7);
+    for (size_t start = 0; start < 20; start++) {
+      // a start tour of the jobs in random order, each inserted at the
+      // first position it fits.
+      vector<size_t> jobs;
+      for (size_t job = 1; job < g.getNodesNum(); job++) {
+        jobs.push_back(job);
+      }
+      std::shuffle(jobs.begin(), jobs.end(), random);
+      search._tour.clear();
+      search._onTour.assign(g.getNodesNum(), 0);
+      search.schedule();
+      for (size_t job : jobs) {
+        for (size_t pos = 0; pos <= search._tour.size(); pos++) {
+          if (search._index->servable(job) && search.insertFits(job, pos)) {
+            search._tour.insert(search._tour.begin() + pos, job);
+            search._onTour[job] = 1;
+            search.schedule();
+            break;
+          }
+        }
+      }
+      size_t kind = start % 2;
+
+      // every applied move is feasible and shortens the tour, and a move
+      // is applied exactly if some candidate of its kind does so.
+      while (true) {
+        const vector<size_t> tour = search._tour;
+        double travel;
+        ASSERT_TRUE(feasible(tour, &travel));
+        bool improving = false;
+        for (size_t pos = 0; pos < tour.size(); pos++) {
+          for (size_t other = 0; other < tour.size(); other++) {
+            vector<size_t> moved = tour;
+            double movedTravel;
+            if (kind == 0) {
+              moved.erase(moved.begin() + pos);
+              if (other == pos || !feasible(moved, &movedTravel)) {continue;}
+              moved.insert(moved.begin() + other, tour[pos]);
+            } else {
+              if (other <= pos) {continue;}
+              std::swap(moved[pos], moved[other]);
+            }
+            if (feasible(moved, &movedTravel)
+                && movedTravel < travel - 1e-9) {
+              improving = true;
+            }
+          }
+        }
+        bool applied = kind == 0 ? search.relocateJob()
+                                 : search.exchangeJobs();
+        ASSERT_EQ(applied, improving) << file << " " << kind;
+        if (!applied) {break;}
+        double movedTravel;
+        ASSERT_TRUE(feasible(search._tour, &movedTravel));
+        ASSERT_LT(movedTravel, travel);
+      }
+    }
+  }
+}
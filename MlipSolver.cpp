@@ -4,232 +4,406 @@
 #include <tuple>
 #include <algorithm>
 #include <vector>
+#include <stdexcept>
 #include <string>
-#include <sstream>
 #include "MlipSolver.h"
 
+// _____________________________________________________________________________
+GRBEnv& MlipSolver::sharedEnv() {
+  // the models inherit the silenced output of the environment.
+  struct QuietEnv {
+    QuietEnv() {
+      env.set(GRB_IntParam_LogToConsole, 0);
+      env.set(GRB_IntParam_OutputFlag, 0);
+    }
+    GRBEnv env;
+  };
+  static thread_local QuietEnv shared;
+  return shared.env;
+}
+
 // _____________________________________________________________________________
 size_t MlipSolver::solve(double timeOut) {
-  _model.set(GRB_IntParam_LogToConsole, 0);
-  _model.set(GRB_IntParam_OutputFlag, 0);
-  _model.set(GRB_StringParam_LogFile, "gurobi.log");
   setupModel();
+  if (!_startTour.empty()) {
+    applyStartTour();
+  }
   _model.optimize();
-  size_t optimum = static_cast<size_t>(_model.get(GRB_DoubleAttr_ObjVal));
+  // with a cutoff there may be no solution at all.
+  if (_model.get(GRB_IntAttr_SolCount) == 0) {
+    return 0;
+  }
+  size_t optimum = static_cast<size_t>(_model.get(GRB_DoubleAttr_ObjVal)
+                                       + 0.5);
   return optimum;
 }
 
 // ____________________________________________________________________________
-void MlipSolver::setupModel() {
-  const size_t totalNodes = _graph.getNodesNum();
-  const size_t startId = 0;
+void MlipSolver::setStartTour(const vector<Location>& tour) {
+  _startTour.clear();
+  for (const auto& loc : tour) {
+    if (loc.id == 0 || loc.id >= _graph->getNodesNum()) {
+      throw std::out_of_range("location " + std::to_string(loc.id)
+                              + " can not be part of a tour");
+    }
+    _startTour.push_back(loc.id);
+  }
+}
+
+// ____________________________________________________________________________
+void MlipSolver::setCutoff(const double cutoff) {
+  _model.set(GRB_DoubleParam_Cutoff, cutoff);
+}
+
+// ____________________________________________________________________________
+void MlipSolver::applyStartTour() {
+  const size_t endId = _graph->getNodesNum();
+  const size_t numVars = endId + 1;
+  const size_t* releases = _graph->getReleases()->data();
+  const size_t* durations = _graph->getDurations()->data();
+
+  // nodes off the tour wait at their release, which satisfies all
+  // constraints of unused edges.
+  vector<double> nodes(numVars, 0.0);
+  vector<double> edges(_arcs.size(), 0.0);
+  vector<double> arrivals(numVars, 0.0);
+  vector<double> leaves(numVars, 0.0);
+  for (size_t i = 1; i < endId; i++) {
+    arrivals[i] = releases[i];
+    leaves[i] = releases[i] + durations[i];
+  }
+
+  // the tour starts anywhere without travelling from the start node.
+  // A tour using an arc that is not in the model can not be feasible
+  // and is not passed on.
+  size_t previous = 0;
+  double leave = 0.0;
+  for (size_t id : _startTour) {
+    size_t arc = findArc(previous, id);
+    if (arc == _arcs.size()) {
+      return;
+    }
+    double travel = previous == 0 ? 0.0 : _graph->distance(previous, id);
+    double arrival = std::max(static_cast<double>(releases[id]),
+                              leave + travel);
+    leave = arrival + durations[id];
+    nodes[id] = 1.0;
+    edges[arc] = 1.0;
+    arrivals[id] = arrival;
+    leaves[id] = leave;
+    previous = id;
+  }
+  edges[findArc(previous, endId)] = 1.0;
+  arrivals[endId] = leave;
+
+  _model.set(GRB_DoubleAttr_Start, _nodes, nodes.data(), numVars);
+  _model.set(GRB_DoubleAttr_Start, _edges, edges.data(), _arcs.size());
+  _model.set(GRB_DoubleAttr_Start, _arrivals, arrivals.data(), numVars);
+  _model.set(GRB_DoubleAttr_Start, _leaves, leaves.data(), numVars);
+}
+
+// ____________________________________________________________________________
+size_t MlipSolver::findArc(const size_t src, const size_t targ) const {
+  for (size_t arc : _outArcs[src]) {
+    if (std::get<1>(_arcs[arc]) == targ) {
+      return arc;
+    }
+  }
+  return _arcs.size();
+}
+
+// ____________________________________________________________________________
+void MlipSolver::initArcs() {
+  const size_t totalNodes = _graph->getNodesNum();
   const size_t endId = totalNodes;
+  const size_t* releases = _graph->getReleases()->data();
+  const size_t* deadlines = _graph->getDeadlines()->data();
+  const size_t* durations = _graph->getDurations()->data();
+  const SuccessorIndex& index = _instance->index();
+
+  // the arcs between nodes are the feasible successors of the index,
+  // the start node reaches every servable location and every location
+  // can end the tour.
+  _arcs.clear();
+  _outArcs.assign(endId + 1, {});
+  _inArcs.assign(endId + 1, {});
+  auto addArc = [this](size_t src, size_t targ) {
+    _outArcs[src].push_back(_arcs.size());
+    _inArcs[targ].push_back(_arcs.size());
+    _arcs.push_back(std::make_tuple(src, targ));
+  };
+  for (size_t src = 0; src < endId; src++) {
+    if (src != 0 && !index.servable(src)) {
+      continue;
+    }
+    const uint32_t* successors = index.successors(src);
+    for (size_t i = 0; i < index.numSuccessors(src); i++) {
+      addArc(src, successors[i]);
+    }
+    addArc(src, endId);
+  }
 
-  // adding a virtual end Node to the graph instance.
-  vector<size_t> releases = *(_graph.getReleases());
-  releases.push_back(0);
-  vector<size_t> deadlines = *(_graph.getDeadlines());
-  deadlines.push_back(1440);
-  vector<size_t> durations = *(_graph.getDurations());
-  durations.push_back(0);
-  vector<size_t> prizes = *(_graph.getPrizes());
-  prizes.push_back(0);
-  vector<vector<double>> distances = *(_graph.getDistances());
-
-  // Distance from startpoint to all locations set to zero.
-  // A tour can immediately start at any location.
-  for (size_t i = 0; i < totalNodes; i++) {
-    distances[0][i] = 0;
-  }
-  // Adding zero distances to virtual end location.
-  for (size_t i = 0; i < totalNodes; i ++) {
-    distances[i].push_back(0);
-  }
-  vector<double> lastRow(totalNodes + 1, 0.0);
-  distances.push_back(lastRow);
-
-  // setup model Variables.
-  _nodes = new GRBVar[totalNodes + 1];
-  _edges = new GRBVar*[totalNodes + 1];
-  for (size_t i = 0; i < totalNodes + 1; i++) {
-    _edges[i] = new GRBVar[totalNodes + 1];
-  }
-  _arrivals = new GRBVar[totalNodes + 1];
-  _leaves = new GRBVar[totalNodes + 1];
-
-  // Nodes.
-  for (size_t id = 1; id < endId; id++) {
-    std::ostringstream nodeName;
-    nodeName << "node" << id;
-    _nodes[id] = _model.addVar(0.0, 1.0, 0.0, GRB_BINARY, nodeName.str());
-  }
-
-  // Edges.
-  for (size_t src = 0; src <= endId; src++) {
-    for (size_t targ = 0; targ <= endId; targ++) {
-      std::ostringstream edgeName;
-      if (src != targ) {
-        edgeName << "edge" << src << targ;
-        _edges[src][targ] = _model.addVar(0.0, 1.0, 0.0,
-                           GRB_BINARY, edgeName.str());
+  // shortest service plus travel times between locations, which need
+  // not follow the direct arcs if distances violate the triangle
+  // inequality. Two locations are incompatible if neither can follow
+  // the other even over a shortest path.
+  size_t n = totalNodes;
+  const vector<double>& shortest = _instance->shortestTravel();
+  auto canPrecede = [&](size_t first, size_t second) {
+    return releases[first] + shortest[first * n + second] + durations[second]
+           <= deadlines[second];
+  };
+  _incompatible.clear();
+  for (size_t i = 1; i < n; i++) {
+    for (size_t j = i + 1; j < n; j++) {
+      if (index.servable(i) && index.servable(j) && !canPrecede(i, j)
+          && !canPrecede(j, i)) {
+        _incompatible.push_back(std::make_tuple(i, j));
       }
     }
   }
+}
+
+// ____________________________________________________________________________
+void MlipSolver::setupModel() {
+  initArcs();
+  const size_t totalNodes = _graph->getNodesNum();
+  const size_t endId = totalNodes;
+  const size_t numVars = totalNodes + 1;
+  const size_t numArcs = _arcs.size();
+
+  // a virtual end node is added to the graph instance. The node data is
+  // read from the graph, only the end node gets its own values.
+  const size_t* graphReleases = _graph->getReleases()->data();
+  const size_t* graphDeadlines = _graph->getDeadlines()->data();
+  const size_t* graphDurations = _graph->getDurations()->data();
+  const size_t* graphPrizes = _graph->getPrizes()->data();
+  auto releases = [&](size_t i) -> double {
+    return i == endId ? 0.0 : graphReleases[i];
+  };
+  auto deadlines = [&](size_t i) -> double {
+    return i == endId ? 1440.0 : graphDeadlines[i];
+  };
+  auto durations = [&](size_t i) -> double {
+    return i == endId ? 0.0 : graphDurations[i];
+  };
+  // Distance from startpoint to all locations stays zero.
+  // A tour can immediately start at any location. Distances to the
+  // virtual end location are zero as well.
+  auto distances = [&](size_t src, size_t targ) -> double {
+    if (src == 0 || src == endId || targ == endId) {
+      return 0.0;
+    }
+    return _graph->distance(src, targ);
+  };
+  // names are only built on request.
+  vector<string> names;
+  auto nameAll = [&](const string& prefix, size_t count) -> const string* {
+    if (!_named) {
+      return nullptr;
+    }
+    names.clear();
+    for (size_t i = 0; i < count; i++) {
+      names.push_back(prefix + std::to_string(i));
+    }
+    return names.data();
+  };
 
-  // Arrivals at all nodes excluding start.
-  for (size_t i = 1; i <= endId; i++) {
-    std::ostringstream name;
-    name << "arrive" << i;
-    double earliestArr = releases[i];
-    double latestArr = deadlines[i] - durations[i];
-    _arrivals[i] = _model.addVar(earliestArr, latestArr, 0.0, GRB_CONTINUOUS,
-                                name.str());
+  // setup model Variables, each kind with one call. The variables of
+  // the start and end node that no constraint uses are fixed to 0, as
+  // are locations that can not be served in their time window.
+  size_t maxVars = std::max(numVars, numArcs);
+  vector<double> lower(maxVars, 0.0);
+  vector<double> upper(maxVars, 1.0);
+  vector<double> objective(maxVars, 0.0);
+  vector<char> binary(maxVars, GRB_BINARY);
+  vector<char> continuous(numVars, GRB_CONTINUOUS);
+
+  // Nodes, the objective is the sum of their prizes.
+  for (size_t id = 0; id < numVars; id++) {
+    bool location = id != 0 && id != endId && !_inArcs[id].empty();
+    upper[id] = location ? 1.0 : 0.0;
+    objective[id] = location ? graphPrizes[id] : 0.0;
   }
+  _nodes = _model.addVars(lower.data(), upper.data(), objective.data(),
+                          binary.data(), nameAll("node", numVars), numVars);
+  _model.set(GRB_IntAttr_ModelSense, GRB_MAXIMIZE);
+
+  // Edges, one per time-feasible arc.
+  std::fill(objective.begin(), objective.end(), 0.0);
+  std::fill(upper.begin(), upper.end(), 1.0);
+  _edges = _model.addVars(lower.data(), upper.data(), objective.data(),
+                          binary.data(), nameAll("edge", numArcs), numArcs);
 
-  for (size_t i = 0; i < endId; i++) {
-    std::ostringstream name;
-    name << "leave" << i;
-    double earliestLeave = releases[i] + durations[i];
-    double latestLeave = deadlines[i];
-    _leaves[i] = _model.addVar(earliestLeave, latestLeave, 0.0, GRB_CONTINUOUS,
-                                name.str());
+  // Arrivals at all nodes excluding start. Unservable locations get a
+  // fixed time so that their bounds stay consistent.
+  vector<double> earliestArrival(numVars);
+  vector<double> latestLeave(numVars);
+  for (size_t i = 0; i <= endId; i++) {
+    earliestArrival[i] = releases(i);
+    latestLeave[i] = deadlines(i);
+    if (releases(i) + durations(i) > deadlines(i)) {
+      latestLeave[i] = releases(i) + durations(i);
+    }
+    lower[i] = earliestArrival[i];
+    upper[i] = latestLeave[i] - durations(i);
   }
+  _arrivals = _model.addVars(lower.data(), upper.data(), objective.data(),
+                             continuous.data(), nameAll("arrive", numVars),
+                             numVars);
 
-  // setup model Objective.
-  GRBLinExpr objFunction = 0;
-  for (size_t i = 1; i < endId; i++) {
-    objFunction += _nodes[i] * prizes[i];
+  // Leaves at all nodes excluding end.
+  for (size_t i = 0; i <= endId; i++) {
+    lower[i] = earliestArrival[i] + durations(i);
+    upper[i] = latestLeave[i];
   }
-  _model.setObjective(objFunction, GRB_MAXIMIZE);
+  _leaves = _model.addVars(lower.data(), upper.data(), objective.data(),
+                           continuous.data(), nameAll("leave", numVars),
+                           numVars);
 
   // setup model constraints.
+  vector<double> coeffs(numVars, 1.0);
+  vector<GRBVar> vars(numVars);
+  auto sumOf = [&](const vector<size_t>& arcs) {
+    for (size_t i = 0; i < arcs.size(); i++) {
+      vars[i] = _edges[arcs[i]];
+    }
+    GRBLinExpr sum = 0;
+    sum.addTerms(coeffs.data(), vars.data(), arcs.size());
+    return sum;
+  };
 
   // Exactly one edge out of start node.
-  GRBLinExpr startOut = 0;
-  for (size_t i = 1; i <= endId; i++) {
-    startOut += _edges[0][i];
-  }
-  _model.addConstr(startOut == 1.0, "startOut");
+  _model.addConstr(sumOf(_outArcs[0]), GRB_EQUAL, 1.0,
+                   _named ? "startOut" : "");
 
   // Exactly one edge into end node.
-  GRBLinExpr endIn = 0;
-  for (size_t i = 0; i < endId; i++) {
-    endIn += _edges[i][endId];
-  }
-  _model.addConstr(endIn == 1.0, "endIn");
+  _model.addConstr(sumOf(_inArcs[endId]), GRB_EQUAL, 1.0,
+                   _named ? "endIn" : "");
 
   // All used nodes have one outgoing and one incoming edge.
-  _nodeOutConstr = new GRBConstr[totalNodes + 1];
-  _nodeInConstr = new GRBConstr[totalNodes + 1];
+  size_t numLocations = totalNodes - 1;
+  vector<GRBLinExpr> sumsOut(numLocations);
+  vector<GRBLinExpr> sumsIn(numLocations);
+  vector<char> equal(numLocations, GRB_EQUAL);
+  vector<double> zeros(numLocations, 0.0);
   for (size_t i = 1; i < endId; i++) {
-    GRBLinExpr sumOut = 0;
-    GRBLinExpr sumIn = 0;
-    for (size_t j = 1; j <= endId; j++) {
-      if (i != j) {
-        sumOut += _edges[i][j];
-      }
-    }
-    for (size_t j = 0; j < endId; j++) {
-      if (i != j) {
-        sumIn += _edges[j][i];
-      }
-    }
-    std::ostringstream cOut;
-    std::ostringstream cIn;
-    cOut << i << "_out_";
-    cIn << i << "_inn_";
-    _nodeOutConstr[i] = _model.addConstr(sumOut == _nodes[i], cOut.str());
-    _nodeOutConstr[i] = _model.addConstr(sumIn == _nodes[i], cIn.str());
-  }
-
-  _durConstr = new GRBConstr[totalNodes + 1];
-  _distConstr = new GRBConstr*[totalNodes + 1];
-  for (size_t i = 0; i < totalNodes + 1; i++) {
-    _distConstr[i] = new GRBConstr[totalNodes + 1];
+    sumsOut[i - 1] = sumOf(_outArcs[i]) - _nodes[i];
+    sumsIn[i - 1] = sumOf(_inArcs[i]) - _nodes[i];
   }
+  _nodeOutConstr = _model.addConstrs(sumsOut.data(), equal.data(),
+                                     zeros.data(), nameAll("out", numLocations),
+                                     numLocations);
+  _nodeInConstr = _model.addConstrs(sumsIn.data(), equal.data(), zeros.data(),
+                                    nameAll("in", numLocations), numLocations);
 
   // Constraints for visiting times.
+  vector<GRBLinExpr> stays(numLocations);
+  vector<double> negativeDurations(numLocations);
   for (size_t i = 1; i < endId; i++) {
-    _durConstr[i] = _model.addConstr(_arrivals[i] + durations[i] == _leaves[i]);
+    stays[i - 1] = _arrivals[i] - _leaves[i];
+    negativeDurations[i - 1] = -durations(i);
   }
+  _durConstr = _model.addConstrs(stays.data(), equal.data(),
+                                 negativeDurations.data(),
+                                 nameAll("dur", numLocations), numLocations);
 
-  // Constraints for reachability of nodes.
-  for (size_t src = 0; src < endId; src++) {
-    for (size_t targ = 1; targ <= endId; targ++) {
-      if (src != targ) {
-        GRBLinExpr factor = 1.0 - _edges[src][targ];
-        GRBLinExpr compValue = 0;
-        if (deadlines[src] + distances[src][targ] > releases[targ]) {
-          compValue = (deadlines[src] + distances[src][targ] - releases[targ])
-                       * factor;
-        }
-        try {
-          _distConstr[src][targ] = _model.addConstr(_leaves[src]
-                                  + distances[src][targ]
-                                  - _arrivals[targ] <= compValue);
-        } catch(GRBException e) {
-          std::cout << e.getErrorCode() << std::endl;
-          exit(1);
-        }
+  // Constraints for reachability of nodes. A used edge forces
+  // leave[src] + distance <= arrival[targ], otherwise it is relaxed by
+  // the largest violation the time windows of both nodes allow:
+  // leave[src] - arrival[targ] + M * edge <= M - distance. Arcs whose
+  // windows can not be violated need no constraint.
+  vector<GRBLinExpr> reaches;
+  vector<double> bounds;
+  for (size_t arc = 0; arc < numArcs; arc++) {
+    size_t src = std::get<0>(_arcs[arc]);
+    size_t targ = std::get<1>(_arcs[arc]);
+    double distance = distances(src, targ);
+    double bigM = latestLeave[src] + distance - earliestArrival[targ];
+    if (bigM <= 0.0) {
+      continue;
+    }
+    double terms[3] = {1.0, -1.0, bigM};
+    GRBVar termVars[3] = {_leaves[src], _arrivals[targ], _edges[arc]};
+    GRBLinExpr reach = 0;
+    reach.addTerms(terms, termVars, 3);
+    reaches.push_back(reach);
+    bounds.push_back(bigM - distance);
+  }
+  vector<char> lessEqual(reaches.size(), GRB_LESS_EQUAL);
+  _distConstr = _model.addConstrs(reaches.data(), lessEqual.data(),
+                                  bounds.data(),
+                                  nameAll("reach", reaches.size()),
+                                  reaches.size());
+
+  // Cuts implied by the time windows. An arc and its reverse can not
+  // both be used, and of two incompatible locations at most one is
+  // visited.
+  vector<GRBLinExpr> cuts;
+  for (size_t arc = 0; arc < numArcs; arc++) {
+    size_t src = std::get<0>(_arcs[arc]);
+    size_t targ = std::get<1>(_arcs[arc]);
+    if (src != 0 && targ != endId && src < targ) {
+      size_t reverse = findArc(targ, src);
+      if (reverse != numArcs) {
+        cuts.push_back(_edges[arc] + _edges[reverse]);
       }
     }
   }
+  for (const auto& pair : _incompatible) {
+    cuts.push_back(_nodes[std::get<0>(pair)] + _nodes[std::get<1>(pair)]);
+  }
+  vector<char> cutSenses(cuts.size(), GRB_LESS_EQUAL);
+  vector<double> ones(cuts.size(), 1.0);
+  _cutConstr = _model.addConstrs(cuts.data(), cutSenses.data(), ones.data(),
+                                 nameAll("cut", cuts.size()), cuts.size());
 }
 
 // ____________________________________________________________________________
 vector<Location> MlipSolver::getTour() {
-  size_t maxNodes = _graph.getNodesNum();
-  vector<tuple<size_t, size_t>> edgesTaken;
-  for (size_t row = 0; row < maxNodes; row++) {
-    for (size_t col = 1; col < maxNodes + 1; col++) {
-      if (row != col) {
-        double edgeValue = _edges[row][col].get(GRB_DoubleAttr_X);
-        if (edgeValue == 1.00) {
-          tuple<size_t, size_t> pathEdge {row, col};
-          edgesTaken.push_back(pathEdge);
-        }
-      }
+  if (_model.get(GRB_IntAttr_SolCount) == 0) {
+    return {};
+  }
+  size_t maxNodes = _graph->getNodesNum();
+  size_t numVars = maxNodes + 1;
+  // fetch all solution values at once.
+  double* edgeValues = _model.get(GRB_DoubleAttr_X, _edges, _arcs.size());
+  double* leaves = _model.get(GRB_DoubleAttr_X, _leaves, numVars);
+  double* arrivals = _model.get(GRB_DoubleAttr_X, _arrivals, numVars);
+
+  // the successor of every node on the tour.
+  vector<size_t> next(numVars, numVars);
+  for (size_t arc = 0; arc < _arcs.size(); arc++) {
+    if (edgeValues[arc] > 0.5) {
+      next[std::get<0>(_arcs[arc])] = std::get<1>(_arcs[arc]);
     }
   }
   vector<Location> path;
-  size_t nextLoc = std::get<1>(edgesTaken[0]);
-  while (true) {
-    if (nextLoc == maxNodes) {
-      break;
-    }
-    for (auto edge : edgesTaken) {
-      if (std::get<0>(edge) == nextLoc) {
-        size_t idx = std::get<0>(edge);
-        double leave = _leaves[idx].get(GRB_DoubleAttr_X);
-        double arrival = _arrivals[idx].get(GRB_DoubleAttr_X);
-        size_t prize = _graph.getPrizes()->at(idx);
-        double lat = std::get<0>(_graph.getLocations()->at(idx));
-        double longit = std::get<1>(_graph.getLocations()->at(idx));
-        string name = _graph.getNodeNames()->at(idx);
-        Location loc = {idx, prize, arrival, leave, lat, longit, name};
-        path.push_back(loc);
-        nextLoc = std::get<1>(edge);
-        break;
-      }
-    }
+  size_t idx = next[0];
+  while (idx < maxNodes) {
+    size_t prize = _graph->getPrizes()->at(idx);
+    double lat = std::get<0>(_graph->getLocations()->at(idx));
+    double longit = std::get<1>(_graph->getLocations()->at(idx));
+    string name = _graph->getNodeNames()->at(idx);
+    Location loc = {idx, prize, arrivals[idx], leaves[idx], lat, longit, name};
+    path.push_back(loc);
+    idx = next[idx];
   }
+  delete[] edgeValues;
+  delete[] leaves;
+  delete[] arrivals;
   return path;
 }
 
 // ____________________________________________________________________________
 MlipSolver::~MlipSolver() {
   delete[] _nodes;
-  for (size_t i = 0; i < _graph.getNodesNum() + 1; i++) {
-    delete[] _edges[i];
-  }
   delete[] _edges;
   delete[] _arrivals;
   delete[] _leaves;
   delete[] _nodeOutConstr;
   delete[] _nodeInConstr;
   delete[] _durConstr;
-  for (size_t i = 0; i < _graph.getNodesNum() + 1; i++) {
-    delete[] _distConstr[i];
-  }
   delete[] _distConstr;
+  delete[] _cutConstr;
 }
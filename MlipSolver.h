@@ -6,9 +6,11 @@
 
 #include <gtest/gtest.h>
 #include "Graph.h"
+#include "Instance.h"
 #include <gurobi_c++.h>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 using std::vector;
@@ -21,42 +23,113 @@ using std::tuple;
 
 class MlipSolver {
  public:
-  // Constructor.
-  explicit MlipSolver(Graph graph): _model(_env) {
-    _graph = graph;
+  // Constructor. threads caps the Gurobi threads of the solve, 0 leaves
+  // the choice to Gurobi. With named set, variables and constraints get
+  // names, which only helps when the model is written to a file.
+  // Solvers of the same shared instance reuse its successor index and
+  // shortest paths.
+  explicit MlipSolver(Graph graph, int threads = 0, bool named = false)
+      : MlipSolver(std::make_shared<const Instance>(std::move(graph)),
+                   threads, named) {}
+  explicit MlipSolver(SharedInstance instance, int threads = 0,
+                      bool named = false)
+      : _model(sharedEnv()) {
+    _instance = instance;
+    _graph = &_instance->graph();
+    _named = named;
+    _nodes = nullptr;
+    _edges = nullptr;
+    _arrivals = nullptr;
+    _leaves = nullptr;
+    _nodeOutConstr = nullptr;
+    _nodeInConstr = nullptr;
+    _durConstr = nullptr;
+    _distConstr = nullptr;
+    _cutConstr = nullptr;
+    _startTour = {};
+    _model.set(GRB_IntParam_Threads, threads);
   }
 
   // Algorithm computing the optimal tour.
   // Returns a tuple containing the value of the otimal tour.
   // and a vector of the locations on the tour.
+  // Returns 0 if there is no tour reaching the cutoff.
   size_t solve(double timeOut = 600.0);
 
-  // To calculate the optimal tour.
+  // To calculate the optimal tour. It is empty if there is no tour
+  // reaching the cutoff.
   vector<Location> getTour();
 
+  // Sets a feasible tour, e.g. from the FptSolver or a heuristic, as the
+  // MIP start of the next solve. Only the ids of the locations are
+  // used, the times are recomputed as early as possible. Ids outside
+  // the locations throw std::out_of_range.
+  void setStartTour(const vector<Location>& tour);
+  FRIEND_TEST(MlipSolverTest, setStartTour);
+
+  // Only tours with a prize strictly above cutoff are of interest,
+  // which lets Gurobi prune the search. A tour with exactly the cutoff
+  // is not returned, so to get back a tour of prize p the cutoff has to
+  // be below p, e.g. p - 0.5 for integer prizes.
+  void setCutoff(double cutoff);
+
   // Destructor
   ~MlipSolver();
 
  private:
+  // The Gurobi environment of the calling thread. It is started once
+  // and shared by all solvers of the thread, so the environment and
+  // license startup is paid once. Gurobi environments must not be used
+  // by several threads at a time, hence one per thread.
+  static GRBEnv& sharedEnv();
+
   // To setup the variables, constraints and
   // objective function of the MLIP.
   void setupModel();
 
-  Graph _graph;  // The graph to solve.
+  // Computes the time-feasible arcs and the pairs of locations that
+  // can not both be on a tour.
+  void initArcs();
+  FRIEND_TEST(MlipSolverTest, initArcs);
+
+  // Index of the arc from src to targ in _arcs or _arcs.size() if the
+  // arc is not time-feasible.
+  size_t findArc(size_t src, size_t targ) const;
+
+  // Passes _startTour to the variables as MIP start.
+  void applyStartTour();
 
-  GRBEnv _env;  // The model environment.
+  SharedInstance _instance;  // The instance to solve.
+  const Graph* _graph;  // The graph of _instance.
+
+  bool _named;  // whether variables and constraints get names.
+
+  vector<size_t> _startTour;  // ids of the MIP start, empty if none.
 
   GRBModel _model;  // The model.
 
-  // Model Variables and Constraints.
+  // Arcs (src, targ) of the model, the virtual end node has id
+  // getNodesNum(). An arc is only kept if targ can be served in time
+  // after src, so the model is sparse for tight time windows.
+  vector<tuple<size_t, size_t>> _arcs;
+  vector<vector<size_t>> _outArcs;  // arc indices leaving each node.
+  vector<vector<size_t>> _inArcs;  // arc indices entering each node.
+
+  // Pairs of locations where neither can be served after the other,
+  // not even over other locations.
+  vector<tuple<size_t, size_t>> _incompatible;
+
+  // Model Variables and Constraints. Variables exist for all nodes and
+  // the virtual end node, _edges has one variable per arc.
   GRBVar* _nodes;
-  GRBVar** _edges;
+  GRBVar* _edges;
   GRBVar* _arrivals;
   GRBVar* _leaves;
   GRBConstr* _nodeOutConstr;
   GRBConstr* _nodeInConstr;
   GRBConstr* _durConstr;
-  GRBConstr** _distConstr;
+  GRBConstr* _distConstr;
+  GRBConstr* _cutConstr;
 };
 
 #endif  // MLIPSOLVER_H_
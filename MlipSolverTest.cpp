@@ -5,6 +5,8 @@
 #include <iostream>
 #include <tuple>
 #include <set>
+#include <stdexcept>
+#include "./FptSolver.h"
 #include "./MlipSolver.h"
 
 // _____________________________________________________________________________
@@ -48,3 +50,60 @@ TEST(FptSolverTest, solve) {
   ASSERT_EQ(path1[1].name, "node3");
   ASSERT_EQ(path1[2].name, "node4");
 }
+
+// _____________________________________________________________________________
+TEST(MlipSolverTest, setStartTour) {
+  Graph g;
+  g.buildFromFile("test_data/example_graph4.graph", false);
+  FptSolver fpt = FptSolver(g);
+  auto result = fpt.solve();
+  vector<Location> fptTour = fpt.getTour(std::get<1>(result));
+
+  // starting from the optimal tour with a cutoff just below its prize,
+  // only tours strictly above the cutoff are returned.
+  MlipSolver solver = MlipSolver(g);
+  solver.setStartTour(fptTour);
+  ASSERT_EQ(solver._startTour.size(), 3);
+  solver.setCutoff(std::get<0>(result) - 0.5);
+  ASSERT_EQ(solver.solve(), 12);
+  auto path = solver.getTour();
+  ASSERT_EQ(path.size(), 3);
+  ASSERT_EQ(path[0].id, 2);
+  ASSERT_EQ(path[1].id, 3);
+  ASSERT_EQ(path[2].id, 4);
+
+  // there is no tour above the optimum.
+  MlipSolver cut = MlipSolver(g);
+  cut.setCutoff(13);
+  ASSERT_EQ(cut.solve(), 0);
+  ASSERT_TRUE(cut.getTour().empty());
+
+  Location start = {0, 0, 0, 0, 0, 0, "starting-point"};
+  ASSERT_THROW(solver.setStartTour({start}), std::out_of_range);
+}
+
+// _____________________________________________________________________________
+TEST(MlipSolverTest, initArcs) {
+  Graph g;
+  g.buildFromFile("test_data/example_graph4.graph", false);
+  MlipSolver solver = MlipSolver(g);
+  solver.initArcs();
+  // only arcs after which the target can still be served are modelled,
+  // in the order of the successor index. The virtual end node has id 5.
+  vector<tuple<size_t, size_t>> expected = {
+    std::make_tuple(0, 4), std::make_tuple(0, 1), std::make_tuple(0, 3),
+    std::make_tuple(0, 2), std::make_tuple(0, 5), std::make_tuple(1, 4),
+    std::make_tuple(1, 5), std::make_tuple(2, 4), std::make_tuple(2, 1),
+    std::make_tuple(2, 3), std::make_tuple(2, 5), std::make_tuple(3, 4),
+    std::make_tuple(3, 5), std::make_tuple(4, 5)};
+  ASSERT_EQ(solver._arcs, expected);
+  ASSERT_EQ(solver._outArcs[2].size(), 4);
+  ASSERT_EQ(solver._inArcs[1].size(), 2);
+  ASSERT_EQ(solver._inArcs[5].size(), 5);
+  ASSERT_EQ(solver.findArc(2, 3), 9);
+  ASSERT_EQ(solver.findArc(3, 1), expected.size());
+
+  // node1 and node3 can not be visited in either order.
+  vector<tuple<size_t, size_t>> incompatible = {std::make_tuple(1, 3)};
+  ASSERT_EQ(solver._incompatible, incompatible);
+}
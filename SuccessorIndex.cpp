@@ -0,0 +1,116 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#include "SuccessorIndex.h"
+#include <stdint.h>
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+// ____________________________________________________________________________
+SuccessorIndex::SuccessorIndex() {
+  _earliestStarts = {};
+  _latestStarts = {};
+  _offsets = {0};
+  _successors = {};
+  _latestLeaves = {};
+  _predOffsets = {0};
+  _predecessors = {};
+  _earliestArrivals = {};
+}
+
+// ____________________________________________________________________________
+SuccessorIndex::SuccessorIndex(const Graph& graph) {
+  size_t nodesNum = graph.getNodesNum();
+  const size_t* releases = graph.getReleases()->data();
+  const size_t* deadlines = graph.getDeadlines()->data();
+  const size_t* durations = graph.getDurations()->data();
+  _earliestStarts.resize(nodesNum);
+  _latestStarts.resize(nodesNum);
+  for (size_t node = 0; node < nodesNum; node++) {
+    _earliestStarts[node] = releases[node];
+    _latestStarts[node] = static_cast<double>(deadlines[node])
+                          - static_cast<double>(durations[node]);
+  }
+
+  // the latest leaves are rounded up by a small slack, so comparing
+  // them never discards a successor the exact deadline check admits.
+  const double slack = 1e-6;
+  _offsets.assign(1, 0);
+  _successors.clear();
+  _latestLeaves.clear();
+  vector<tuple<double, uint32_t>> row;
+  for (size_t node = 0; node < nodesNum; node++) {
+    row.clear();
+    if (node == 0) {
+      for (size_t job = 1; job < nodesNum; job++) {
+        if (servable(job)) {
+          row.push_back(std::make_tuple(_latestStarts[job] + slack, job));
+        }
+      }
+    } else if (servable(node)) {
+      double leave = releases[node] + static_cast<double>(durations[node]);
+      for (size_t job = 1; job < nodesNum; job++) {
+        if (job == node || !servable(job)) {
+          continue;
+        }
+        double travelTime = graph.distance(node, job);
+        // the same test as the deadline check of the FptSolver.
+        if (leave + travelTime + static_cast<double>(durations[job])
+            > static_cast<double>(deadlines[job])) {
+          continue;
+        }
+        row.push_back(std::make_tuple(_latestStarts[job] - travelTime + slack,
+                                      job));
+      }
+    }
+    // decreasing latest leave, ties by increasing id.
+    std::sort(row.begin(), row.end(),
+              [](const tuple<double, uint32_t>& a,
+                 const tuple<double, uint32_t>& b) {
+                if (std::get<0>(a) != std::get<0>(b)) {
+                  return std::get<0>(a) > std::get<0>(b);
+                }
+                return std::get<1>(a) < std::get<1>(b);
+              });
+    for (const auto& entry : row) {
+      _latestLeaves.push_back(std::get<0>(entry));
+      _successors.push_back(std::get<1>(entry));
+    }
+    _offsets.push_back(_successors.size());
+  }
+
+  // the predecessors are collected from the rows of the jobs, the
+  // starting point precedes every job without being a job itself. The
+  // earliest arrivals are rounded down by the slack.
+  vector<vector<tuple<double, uint32_t>>> columns(nodesNum);
+  for (size_t node = 1; node < nodesNum; node++) {
+    double leave = releases[node] + static_cast<double>(durations[node]);
+    for (size_t i = _offsets[node]; i < _offsets[node + 1]; i++) {
+      uint32_t job = _successors[i];
+      columns[job].push_back(std::make_tuple(
+          leave + graph.distance(node, job) - slack, node));
+    }
+  }
+  _predOffsets.assign(1, 0);
+  _predecessors.clear();
+  _earliestArrivals.clear();
+  for (auto& column : columns) {
+    std::sort(column.begin(), column.end());
+    for (const auto& entry : column) {
+      _earliestArrivals.push_back(std::get<0>(entry));
+      _predecessors.push_back(std::get<1>(entry));
+    }
+    _predOffsets.push_back(_predecessors.size());
+  }
+}
+
+// ____________________________________________________________________________
+size_t SuccessorIndex::getNodesNum() const {
+  return _earliestStarts.size();
+}
+
+// ____________________________________________________________________________
+size_t SuccessorIndex::numArcs() const {
+  return _successors.size();
+}
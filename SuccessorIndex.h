@@ -0,0 +1,88 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#ifndef SUCCESSORINDEX_H_
+#define SUCCESSORINDEX_H_
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <vector>
+#include "./Graph.h"
+
+using std::vector;
+
+// Preprocessing of a graph shared by both solvers. It holds the service
+// window of every node and, in compressed rows, the successors that can
+// follow a node at all. Node 0 is the starting point, a tour starts at
+// any job without travelling, so its successors are all servable jobs.
+class SuccessorIndex {
+ public:
+  // Constructors, the default one builds an empty index.
+  SuccessorIndex();
+  explicit SuccessorIndex(const Graph& graph);
+
+  // Number of nodes of the graph.
+  size_t getNodesNum() const;
+
+  // Earliest and latest start of the service at a node. A tour can
+  // start at every job, so reachability from the starting point does
+  // not move the release, and a tour can end at every job, so the
+  // latest start is the deadline minus the duration.
+  double earliestStart(size_t node) const { return _earliestStarts[node]; }
+  double latestStart(size_t node) const { return _latestStarts[node]; }
+
+  // Whether the node is a job that fits into its own time window. Other
+  // jobs are never a successor.
+  bool servable(size_t node) const {
+    return node != 0 && _earliestStarts[node] <= _latestStarts[node];
+  }
+
+  // The successors of a node that can be served after leaving it at
+  // its earliest time. They are sorted by decreasing latest leave, the
+  // latest time to leave node and still serve the successor, which is
+  // its deadline minus its duration and the travel time. Once a tour
+  // leaves node after latestLeaves(node)[i], none of the successors
+  // from i on can be served.
+  size_t numSuccessors(size_t node) const {
+    return _offsets[node + 1] - _offsets[node];
+  }
+  const uint32_t* successors(size_t node) const {
+    return _successors.data() + _offsets[node];
+  }
+  const double* latestLeaves(size_t node) const {
+    return _latestLeaves.data() + _offsets[node];
+  }
+
+  // The jobs that can precede a job, the transposed successor rows. They
+  // are sorted by increasing earliest arrival, the time the job is
+  // reached after serving the predecessor at its release. A job that
+  // has to start by time t can not be preceded by the predecessors from
+  // the first i with earliestArrivals(node)[i] > t on.
+  size_t numPredecessors(size_t node) const {
+    return _predOffsets[node + 1] - _predOffsets[node];
+  }
+  const uint32_t* predecessors(size_t node) const {
+    return _predecessors.data() + _predOffsets[node];
+  }
+  const double* earliestArrivals(size_t node) const {
+    return _earliestArrivals.data() + _predOffsets[node];
+  }
+
+  // Total number of successor entries.
+  size_t numArcs() const;
+
+ private:
+  vector<double> _earliestStarts;
+  vector<double> _latestStarts;
+
+  // Row node of the index is [_offsets[node], _offsets[node + 1]).
+  vector<size_t> _offsets;
+  vector<uint32_t> _successors;
+  vector<double> _latestLeaves;
+  vector<size_t> _predOffsets;
+  vector<uint32_t> _predecessors;
+  vector<double> _earliestArrivals;
+  FRIEND_TEST(SuccessorIndexTest, build);
+};
+
+#endif  // SUCCESSORINDEX_H_
@@ -0,0 +1,59 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "./SuccessorIndex.h"
+
+// _____________________________________________________________________________
+TEST(SuccessorIndexTest, build) {
+  Graph g;
+  g.buildFromFile("test_data/example_graph4.graph", false);
+  SuccessorIndex index(g);
+  ASSERT_EQ(index.getNodesNum(), 5);
+  ASSERT_EQ(index._offsets.size(), 6);
+  ASSERT_EQ(index.earliestStart(3), 6);
+  ASSERT_EQ(index.latestStart(3), 6);
+  ASSERT_FALSE(index.servable(0));
+  ASSERT_TRUE(index.servable(4));
+
+  // the start node precedes all jobs, by decreasing latest start.
+  vector<uint32_t> start(index.successors(0),
+                         index.successors(0) + index.numSuccessors(0));
+  ASSERT_EQ(start, vector<uint32_t>({4, 1, 3, 2}));
+
+  // leaving node2 at 1, node3 is only reached if leaving by 1.
+  vector<uint32_t> row(index.successors(2),
+                       index.successors(2) + index.numSuccessors(2));
+  ASSERT_EQ(row, vector<uint32_t>({4, 1, 3}));
+  ASSERT_NEAR(index.latestLeaves(2)[0], 6, 1e-5);
+  ASSERT_NEAR(index.latestLeaves(2)[1], 5, 1e-5);
+  ASSERT_NEAR(index.latestLeaves(2)[2], 1, 1e-5);
+  ASSERT_GE(index.latestLeaves(2)[2], 1);
+
+  // nothing can follow node4 and node1 only reaches node4.
+  ASSERT_EQ(index.numSuccessors(4), 0);
+  ASSERT_EQ(index.numSuccessors(1), 1);
+  ASSERT_EQ(index.successors(1)[0], 4);
+  ASSERT_EQ(index.numArcs(), 4 + 1 + 3 + 1);
+
+  // a job longer than its window is neither a node nor a successor.
+  const string fileName = "SuccessorIndexTest.build.graph";
+  std::ofstream(fileName) << "3\n"
+      << "0\tstart\t(0.0, 0.0)\t0\t0\t0\t0\n"
+      << "1\tshort\t(0.0, 0.0)\t4\t6\t3\t1\n"
+      << "2\tlong\t(0.0, 0.0)\t0\t20\t1\t1\n"
+      << "0 1 1\n1 0 1\n1 1 0\n";
+  Graph tight;
+  tight.buildFromFile(fileName);
+  std::remove(fileName.c_str());
+  SuccessorIndex tightIndex(tight);
+  ASSERT_FALSE(tightIndex.servable(1));
+  ASSERT_EQ(tightIndex.numSuccessors(0), 1);
+  ASSERT_EQ(tightIndex.successors(0)[0], 2);
+  ASSERT_EQ(tightIndex.numSuccessors(1), 0);
+  ASSERT_EQ(tightIndex.numSuccessors(2), 0);
+}
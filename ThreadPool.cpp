@@ -0,0 +1,75 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#include "ThreadPool.h"
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// _____________________________________________________________________________
+ThreadPool::ThreadPool(const size_t numThreads) {
+  _task = nullptr;
+  _numTasks = 0;
+  _nextTask = 0;
+  _doneTasks = 0;
+  _stop = false;
+  for (size_t i = 0; i < numThreads; i++) {
+    _workers.push_back(std::thread(&ThreadPool::work, this));
+  }
+}
+
+// _____________________________________________________________________________
+size_t ThreadPool::size() const {
+  return _workers.size();
+}
+
+// _____________________________________________________________________________
+void ThreadPool::run(const size_t numTasks,
+                     const std::function<void(size_t)>& task) {
+  if (numTasks == 0) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(_mutex);
+  _task = &task;
+  _numTasks = numTasks;
+  _nextTask = 0;
+  _doneTasks = 0;
+  _wakeUp.notify_all();
+  _finished.wait(lock, [this] { return _doneTasks == _numTasks; });
+  _task = nullptr;
+}
+
+// _____________________________________________________________________________
+void ThreadPool::work() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (true) {
+    _wakeUp.wait(lock, [this] {
+      return _stop || (_task != nullptr && _nextTask < _numTasks);
+    });
+    if (_stop) {
+      return;
+    }
+    size_t idx = _nextTask++;
+    const std::function<void(size_t)>* task = _task;
+    lock.unlock();
+    (*task)(idx);
+    lock.lock();
+    _doneTasks++;
+    if (_doneTasks == _numTasks) {
+      _finished.notify_one();
+    }
+  }
+}
+
+// _____________________________________________________________________________
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _wakeUp.notify_all();
+  for (auto& worker : _workers) {
+    worker.join();
+  }
+}
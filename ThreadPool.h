@@ -0,0 +1,48 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using std::vector;
+
+// A fixed set of worker threads that run batches of indexed tasks.
+
+class ThreadPool {
+ public:
+  // Constructor starting numThreads workers.
+  explicit ThreadPool(size_t numThreads);
+
+  // Runs task(0), ..., task(numTasks - 1) on the workers and returns
+  // once all of them are finished. Tasks are handed out in increasing
+  // order, but may finish in any order.
+  void run(size_t numTasks, const std::function<void(size_t)>& task);
+
+  // Number of worker threads.
+  size_t size() const;
+
+  // Destructor, joins all workers.
+  ~ThreadPool();
+
+ private:
+  // Loop executed by each worker.
+  void work();
+
+  vector<std::thread> _workers;
+  std::mutex _mutex;
+  std::condition_variable _wakeUp;  // signals a new batch or stopping.
+  std::condition_variable _finished;  // signals the end of a batch.
+  const std::function<void(size_t)>* _task;
+  size_t _numTasks;
+  size_t _nextTask;
+  size_t _doneTasks;
+  bool _stop;
+};
+
+#endif  // THREADPOOL_H_
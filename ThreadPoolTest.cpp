@@ -0,0 +1,29 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
+#include "./ThreadPool.h"
+
+// _____________________________________________________________________________
+TEST(ThreadPoolTest, run) {
+  ThreadPool pool(4);
+  ASSERT_EQ(pool.size(), 4);
+  vector<size_t> results(100, 0);
+  std::atomic<size_t> calls(0);
+  // several batches on the same pool.
+  for (size_t batch = 1; batch <= 3; batch++) {
+    pool.run(results.size(), [&](size_t idx) {
+      results[idx] += idx * batch;
+      calls++;
+    });
+  }
+  ASSERT_EQ(calls, 300);
+  for (size_t i = 0; i < results.size(); i++) {
+    ASSERT_EQ(results[i], 6 * i);
+  }
+  // an empty batch returns immediately.
+  pool.run(0, [&](size_t) { calls++; });
+  ASSERT_EQ(calls, 300);
+}
@@ -0,0 +1,150 @@
+// Copyright 2018
+// Author: Felix Freyland <felix.freyland@gmx.de>
+
+#include <benchmark/benchmark.h>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "./FptSolver.h"
+#include "./Graph.h"
+#include "./LocalSearch.h"
+#include "./MlipSolver.h"
+
+using boost::filesystem::path;
+using boost::filesystem::directory_iterator;
+using std::string;
+using std::vector;
+
+// Microbenchmarks of the hot paths on the size classes in graph_data.
+// Every benchmark runs with the arguments {size, cluster}, where
+// cluster selects graph_data/<size>_cluster over <size>_random. One
+// iteration processes all instances of the class and all times are
+// reported in nanoseconds. Run it from the repository root, e.g. with
+// make bench, which builds it with optimisation.
+
+// The sorted instance files of a size class.
+static vector<string> classFiles(const int64_t size, const bool cluster) {
+  path dir("graph_data/" + std::to_string(size)
+           + (cluster ? "_cluster" : "_random"));
+  vector<string> files;
+  for (directory_iterator it(dir); it != directory_iterator(); ++it) {
+    files.push_back(it->path().string());
+  }
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+// The graphs of a size class.
+static vector<Graph> classGraphs(const int64_t size, const bool cluster) {
+  vector<Graph> graphs;
+  for (const auto& file : classFiles(size, cluster)) {
+    Graph g;
+    g.buildFromFile(file);
+    graphs.push_back(g);
+  }
+  return graphs;
+}
+
+// The 95th percentile of the repetitions.
+static double percentile95(const vector<double>& values) {
+  vector<double> sorted = values;
+  std::sort(sorted.begin(), sorted.end());
+  size_t rank = static_cast<size_t>(std::ceil(0.95 * sorted.size()));
+  return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+// All size classes, repeated to report median and p95 besides the mean.
+static void sizeClasses(benchmark::internal::Benchmark* b) {
+  for (int64_t size : {10, 15, 20, 25}) {
+    for (int64_t cluster : {0, 1}) {
+      b->Args({size, cluster});
+    }
+  }
+  b->ArgNames({"size", "cluster"});
+  b->Repetitions(10);
+  b->ComputeStatistics("p95", percentile95);
+}
+
+// _____________________________________________________________________________
+static void BM_buildFromFile(benchmark::State& state) {
+  vector<string> files = classFiles(state.range(0), state.range(1));
+  for (auto _ : state) {
+    for (const auto& file : files) {
+      Graph g;
+      g.buildFromFile(file);
+      benchmark::DoNotOptimize(g.distance(0, 0));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * files.size());
+}
+BENCHMARK(BM_buildFromFile)->Apply(sizeClasses);
+
+// _____________________________________________________________________________
+static void BM_FptSolve(benchmark::State& state) {
+  vector<Graph> graphs = classGraphs(state.range(0), state.range(1));
+  for (auto _ : state) {
+    for (const auto& graph : graphs) {
+      FptSolver solver(graph);
+      auto result = solver.solve();
+      benchmark::DoNotOptimize(result);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * graphs.size());
+}
+BENCHMARK(BM_FptSolve)->Apply(sizeClasses)->Unit(benchmark::kNanosecond);
+
+// _____________________________________________________________________________
+static void BM_FptGetTour(benchmark::State& state) {
+  vector<Graph> graphs = classGraphs(state.range(0), state.range(1));
+  vector<FptSolver> solvers;
+  vector<tuple<size_t, size_t, size_t>> tourEnds;
+  for (const auto& graph : graphs) {
+    solvers.push_back(FptSolver(graph));
+    tourEnds.push_back(std::get<1>(solvers.back().solve()));
+  }
+  for (auto _ : state) {
+    for (size_t i = 0; i < solvers.size(); i++) {
+      vector<Location> tour = solvers[i].getTour(tourEnds[i]);
+      benchmark::DoNotOptimize(tour.data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * graphs.size());
+}
+BENCHMARK(BM_FptGetTour)->Apply(sizeClasses);
+
+// _____________________________________________________________________________
+static void BM_LocalSearch(benchmark::State& state) {
+  vector<Graph> graphs = classGraphs(state.range(0), state.range(1));
+  // a fixed number of rounds instead of the time limit.
+  LocalSearchOptions options;
+  options.rounds = 100;
+  for (auto _ : state) {
+    for (const auto& graph : graphs) {
+      LocalSearch search(graph, options);
+      benchmark::DoNotOptimize(search.solve({}));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * graphs.size());
+}
+BENCHMARK(BM_LocalSearch)->Apply(sizeClasses)
+    ->Unit(benchmark::kNanosecond);
+
+// _____________________________________________________________________________
+static void BM_MlipSolve(benchmark::State& state) {
+  vector<Graph> graphs = classGraphs(state.range(0), state.range(1));
+  for (auto _ : state) {
+    for (const auto& graph : graphs) {
+      MlipSolver solver(graph);
+      benchmark::DoNotOptimize(solver.solve());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * graphs.size());
+}
+// the MLIP takes seconds per class, a single iteration per repetition.
+BENCHMARK(BM_MlipSolve)->Apply(sizeClasses)->Iterations(1)
+    ->Unit(benchmark::kNanosecond);
+
+BENCHMARK_MAIN();
@@ -1,6 +1,7 @@
 // Copyright 2018
 // Author: Felix Freyland <felix.freyland@gmx.de>
 
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
@@ -21,30 +22,53 @@ using std::cout;
 // calculates the optimal tours for all data with FPT and MLIP solver
 // and writes runtimes and paths textfiles.
 int main(int argc, char *argv[]) {
-  if (argc < 3 || argc > 4) {
+  if (argc < 3) {
     fprintf(stderr, "Usage1: ./TwTspMain <read_path> <write_path>\n");
     fprintf(stderr, "Usage2: ./TwTspMain <read_path> <write_path> --UP\n");
     fprintf(stderr, "Usage2 calculates tours with unit prizes for locations\n");
+    fprintf(stderr, "Add --threads=<n> to solve n instances at a time\n");
+    fprintf(stderr, "Add --bidirectional for bidirectional FPT labels\n");
+    fprintf(stderr, "Add --ng=<k> to relax the FPT labels to k neighbours\n");
+    fprintf(stderr, "Add --beam=<w> to keep w FPT labels per cell\n");
     exit(1);
-  } else if (argc == 3) {
-    Evaluator ev;
-    string inPath = argv[1];
-    string outPath = argv[2];
-    ev.evaluate(inPath);
-    ev.writeResults(outPath);
-  } else {
-    string unitPrize = argv[3];
-    if (unitPrize == "--UP") {
-    Evaluator ev;
-    string inPath = argv[1];
-    string outPath = argv[2];
-    ev.evaluate(inPath, true);
-    ev.writeResults(outPath, true);
+  }
+  bool unitPrize = false;
+  size_t threads = 1;
+  FptOptions fptOptions;
+  for (int i = 3; i < argc; i++) {
+    string option = argv[i];
+    if (option == "--UP") {
+      unitPrize = true;
+    } else if (option.compare(0, 10, "--threads=") == 0
+               && atoi(option.c_str() + 10) > 0) {
+      threads = atoi(option.c_str() + 10);
+    } else if (option == "--bidirectional") {
+      fptOptions.bidirectional = true;
+    } else if (option.compare(0, 5, "--ng=") == 0
+               && atoi(option.c_str() + 5) > 0) {
+      fptOptions.ngSize = atoi(option.c_str() + 5);
+    } else if (option.compare(0, 7, "--beam=") == 0
+               && atoi(option.c_str() + 7) > 0) {
+      fptOptions.beamWidth = atoi(option.c_str() + 7);
     } else {
-      fprintf(stderr, "%s is not a valid cammand line argument\n", argv[3]);
+      fprintf(stderr, "%s is not a valid cammand line argument\n", argv[i]);
       fprintf(stderr, "Use --UP for non unit prizes\n");
+      fprintf(stderr, "Use --threads=<n> for n parallel instances\n");
+      fprintf(stderr, "Use --bidirectional for bidirectional FPT labels\n");
+      fprintf(stderr, "Use --ng=<k> for labels relaxed to k neighbours\n");
+      fprintf(stderr, "Use --beam=<w> for at most w labels per cell\n");
       exit(1);
     }
   }
+  Evaluator ev(threads, fptOptions);
+  string inPath = argv[1];
+  string outPath = argv[2];
+  try {
+    ev.evaluate(inPath, unitPrize);
+  } catch (const GraphParseError& error) {
+    fprintf(stderr, "%s\n", error.what());
+    exit(1);
+  }
+  ev.writeResults(outPath, unitPrize);
   return 0;
 }